@@ -0,0 +1,148 @@
+#ifndef __NATASHA_CASCADETABLE_H__
+#define __NATASHA_CASCADETABLE_H__
+
+#include <assert.h>
+#include <functional>
+#include <map>
+#include <vector>
+#include "../protoc/base.pb.h"
+#include "gamelogic.h"
+#include "markovchain.h"
+#include "userinfo.h"
+
+// cascade markov model
+//   每一次 cascade 是一个状态（key），状态只和 turnNums 这类信息有关
+//   状态转移概率、条件赢得都由真实的 gameCtrl 采样得到，金额都换算成 totalbet
+//   然后把 BG / FG 建成吸收马尔可夫链，解出 RTP，不需要长时间的 Monte Carlo
+
+namespace natasha {
+
+// max key nums for each game module
+const int CASCADE_MAX_KEYNUMS = 64;
+// max remaining free spins in markov chain
+const int CASCADE_MAX_FREENUMS = 256;
+// max cached free spins in markov chain, only for FG start at the end
+const int CASCADE_MAX_FGCACHE = 64;
+
+// CascadeStep - statistics of one (module, key), money is in totalbet
+struct CascadeStep {
+  // (next key, fgnums) -> nums, next key is -1 if the cascade is end
+  typedef std::map<std::pair<int, int>, int64_t> MapTransition;
+
+  int64_t nums;
+  // win - sum of win, without awardmul
+  double win;
+  // realwin - sum of realwin
+  double realwin;
+  // bonus - sum of SPECIAL win / mul, can be resolved with other prizes
+  double bonus;
+
+  MapTransition mapTransition;
+
+  CascadeStep() : nums(0), win(0), realwin(0), bonus(0) {}
+
+  double getMeanWin() const { return nums > 0 ? win / nums : 0; }
+
+  double getMeanRealWin() const { return nums > 0 ? realwin / nums : 0; }
+
+  double getMeanBonus() const { return nums > 0 ? bonus / nums : 0; }
+};
+
+// CascadeTable - sampled cascade steps for every game module
+class CascadeTable {
+ public:
+  typedef std::vector<CascadeStep> CascadeStepList;
+  typedef std::map< ::natashapb::GAMEMODTYPE, CascadeStepList> MapCascadeStep;
+
+ public:
+  CascadeTable() : m_spinNums(0) {}
+  ~CascadeTable() {}
+
+ public:
+  void clear();
+
+  // addStep - add a cascade step
+  void addStep(::natashapb::GAMEMODTYPE module, int key, int nextKey,
+               int fgnums, double win, double realwin, double bonus);
+
+  // addSpinNums - paid spins in base game
+  void addSpinNums(int64_t nums) { m_spinNums += nums; }
+
+  // merge - merge other table
+  void merge(const CascadeTable& table);
+
+  // getStep - get step, NULL if not found
+  const CascadeStep* getStep(::natashapb::GAMEMODTYPE module, int key) const;
+
+  // getKeyNums - max key + 1
+  int getKeyNums(::natashapb::GAMEMODTYPE module) const;
+
+  int64_t getSpinNums() const { return m_spinNums; }
+
+  // getTotalRealWin - sum of realwin in all steps
+  double getTotalRealWin() const;
+
+ protected:
+  MapCascadeStep m_mapStep;
+  int64_t m_spinNums;
+};
+
+// FuncCascadeKey - key of user game module info, in [0, CASCADE_MAX_KEYNUMS)
+//                - the key of a new spin must be 0
+typedef std::function<int(::natashapb::GAMEMODTYPE module,
+                          const ::natashapb::UserGameModInfo* pUGMI)>
+    FuncCascadeKey;
+
+// FuncCascadeReward - expected reward(totalbet) of one step
+typedef std::function<double(::natashapb::GAMEMODTYPE module, int key,
+                             const CascadeStep& step)>
+    FuncCascadeReward;
+
+// CascadeModel - how the game starts free game
+struct CascadeModel {
+  // isFGImmediately - true if FG starts when scatter appears (TLOD)
+  //                 - false if FG starts at the end of cascade (Museum FGCache)
+  bool isFGImmediately;
+  int maxFreeNums;
+  int maxFGCache;
+
+  CascadeModel()
+      : isFGImmediately(false),
+        maxFreeNums(CASCADE_MAX_FREENUMS),
+        maxFGCache(CASCADE_MAX_FGCACHE) {}
+};
+
+// CascadeRTPResult - result of markov chain, for one paid spin
+struct CascadeRTPResult {
+  double bgRTP;
+  double fgRTP;
+  double totalRTP;
+  // fgTriggerNums - expected FG triggers
+  double fgTriggerNums;
+  // fgSpinNums - expected free spins, with retriggers
+  double fgSpinNums;
+};
+
+// sampleCascadeTable - run gameCtrl until spinNums paid spins are completed
+//                    - 用真实的游戏逻辑采样，记录每一次 cascade
+::natashapb::CODE sampleCascadeTable(GameLogic& logic, UserInfo* pUser,
+                                     ::natashapb::GameCtrl* pGameCtrlBG,
+                                     ::natashapb::GameCtrl* pGameCtrlFG,
+                                     int64_t spinNums, FuncCascadeKey funcKey,
+                                     CascadeTable& table);
+
+// getCascadeMeanRealWin - default FuncCascadeReward
+double getCascadeMeanRealWin(::natashapb::GAMEMODTYPE module, int key,
+                             const CascadeStep& step);
+
+// solveCascadeRTP - solve BG / FG markov chain
+//                 - 修改 multipliers 这类不影响盘面的参数时，只需要换 funcReward
+bool solveCascadeRTP(const CascadeTable& table, const CascadeModel& model,
+                     FuncCascadeReward funcReward, CascadeRTPResult& result);
+
+// outputCascadeRTPResult - print result
+void outputCascadeRTPResult(const char* name, const CascadeRTPResult& result);
+
+}  // namespace natasha
+
+#endif  // __NATASHA_CASCADETABLE_H__
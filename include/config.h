@@ -2,14 +2,63 @@
 #define __NATASHA_CONFIG_H__
 
 #include <assert.h>
+#include <vector>
 #include "../protoc/base.pb.h"
 
 namespace natasha {
 
+// WeightTable - compiled WeightConfig, no protobuf in the hot path
+struct WeightTable {
+  std::vector<int> lstWeight;
+  int totalWeight;
+
+  WeightTable() : totalWeight(0) {}
+};
+
 int sumWeightConfig(const ::natashapb::WeightConfig& cfg);
 
 int randWeightConfig(const ::natashapb::WeightConfig& cfg);
 
+// isValidWeightConfig - not empty, no negative weight, and totalweight is the
+//                       sum of weights (> 0)
+bool isValidWeightConfig(const ::natashapb::WeightConfig& cfg);
+
+// compileWeightConfig - WeightConfig -> WeightTable
+void compileWeightConfig(const ::natashapb::WeightConfig& cfg,
+                         WeightTable& table);
+
+// randWeightTable - same random draws as randWeightConfig
+int randWeightTable(const WeightTable& table);
+
+// AliasTable - weights with Vose's alias method, O(1) for any number of
+//              weights
+//            - 第 i 格自己的部分是 lstProb[i]，剩下的 totalWeight - lstProb[i]
+//              是 lstAlias[i] 的
+//            - 全是整数，概率和 weight / totalWeight 完全一样，
+//              但随机数的用法和 randWeightTable 不同，同一个 seed 结果不同
+struct AliasTable {
+  std::vector<int> lstProb;
+  std::vector<int> lstAlias;
+  int totalWeight;
+
+  AliasTable() : totalWeight(0) {}
+
+  bool isEmpty() const { return totalWeight <= 0; }
+};
+
+// buildAliasTable - weights -> AliasTable, false if empty, negative or the
+//                   total is 0 or too big
+bool buildAliasTable(const std::vector<int>& lstWeight, AliasTable& table);
+
+// compileAliasTable - WeightConfig -> AliasTable, false if not
+//                     isValidWeightConfig
+bool compileAliasTable(const ::natashapb::WeightConfig& cfg,
+                       AliasTable& table);
+
+// randAliasTable - return [0, weights), one randomScale if weights *
+//                  totalWeight fits in uint32_t
+int randAliasTable(const AliasTable& table);
+
 }  // namespace natasha
 
 #endif  // __NATASHA_CONFIG_H__
\ No newline at end of file
@@ -3,6 +3,11 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include "randomjournal.h"
+#ifdef NATASHA_SIMULATION
+#include "randomreplay.h"
+#include "xoshiro256.h"
+#endif  // NATASHA_SIMULATION
 
 namespace natasha {
 
@@ -10,8 +15,87 @@ namespace natasha {
 uint32_t random();
 
 // randomScale - return [0, max)
+//             - 乘法缩放加拒绝，没有偏差，大部分时候不用取模
 uint32_t randomScale(uint32_t max);
 
+// randomArray - fill nums uint32 numbers in one request
+//             - fortuna 每次请求都要 rekey，一次取完比逐个取快
+void randomArray(uint32_t* pOut, int nums);
+
+// randomScaleArray - fill nums numbers in [0, max) with one randomArray
+//                  - 被拒绝的才单独再取
+void randomScaleArray(uint32_t* pOut, int nums, uint32_t max);
+
+// randomScaleList - fill pOut[i] in [0, pMax[i]) with one randomArray
+//                 - 比如每个轴的长度不一样时，一次取 5 个停止位置
+void randomScaleList(uint32_t* pOut, const uint32_t* pMax, int nums);
+
+// EntropyMetrics - counters of the entropy thread
+//   harvestNums - reads of system entropy
+//   harvestBytes - bytes of system entropy added to fortuna
+//   reseedNums - reseeds done by the entropy thread
+//   totalReseedNums - all reseeds of fortuna, with the ones in
+//                     fortuna_get_bytes
+//   maxReseedTime - the longest time fortuna was locked by a reseed, in ns
+//   lastReseedTime - time of the last reseed, steady clock in ms
+struct EntropyMetrics {
+  int64_t harvestNums;
+  int64_t harvestBytes;
+  int64_t reseedNums;
+  int64_t totalReseedNums;
+  int64_t maxReseedTime;
+  int64_t lastReseedTime;
+};
+
+// startEntropyThread - harvest system entropy and reseed fortuna every
+//                      intervalms in a thread, false if already started
+//                    - 启动以后 fortuna_get_bytes 里不再 reseed，
+//                      取随机数时不会读系统熵，也不会算 sha256
+//                    - 进程退出前要 stopEntropyThread
+bool startEntropyThread(int intervalms);
+
+// stopEntropyThread - stop the entropy thread, fortuna reseeds in
+//                     fortuna_get_bytes again
+void stopEntropyThread();
+
+// isEntropyThreadRunning - is the entropy thread running
+bool isEntropyThreadRunning();
+
+// getEntropyMetrics - counters of the entropy thread
+void getEntropyMetrics(EntropyMetrics& metrics);
+
+// setThreadRandomJournal - record the draws of current thread in pJournal,
+//                          NULL to stop, returns the last one
+//                        - 只记录 random、randomScale 这些接口返回的值
+RandomJournal* setThreadRandomJournal(RandomJournal* pJournal);
+
+#ifdef NATASHA_SIMULATION
+// setThreadRandomReplay - current thread draws from pReplay instead of the
+//                         rng, NULL to stop, returns the last one
+//                       - 和 resetRandomSeed 一样，正式服务器不能用
+RandomReplay* setThreadRandomReplay(RandomReplay* pReplay);
+
+// resetRandomSeed - reset random with fixed seed
+//                 - 只给benchmark和模拟用，结果只和seed有关
+//                 - 只有定义了 NATASHA_SIMULATION 才有，正式服务器不能用
+void resetRandomSeed(uint64_t seed);
+
+// setThreadRandomSeed - current thread uses xoshiro256** with seed
+//                     - 只给多线程模拟用，每个线程用自己的seed
+void setThreadRandomSeed(uint64_t seed);
+
+// setThreadRandomStream - current thread uses stream of seed, see
+//                         Xoshiro256::seedStream
+//                       - stream 0 和 setThreadRandomSeed(seed) 一样
+void setThreadRandomStream(uint64_t seed, uint64_t stream);
+
+// setThreadRandomState - current thread uses xoshiro256** from state
+void setThreadRandomState(const Xoshiro256& state);
+
+// clearThreadRandomSeed - current thread uses fortuna again
+void clearThreadRandomSeed();
+#endif  // NATASHA_SIMULATION
+
 }  // namespace natasha
 
 #endif  // __NATASHA_FORTUNA_H__
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include "../protoc/base.pb.h"
+#include "fortuna.h"
 #include "gamelogic.h"
 #include "lines.h"
 #include "logicline2.h"
@@ -15,6 +16,7 @@
 #include "paytables.h"
 #include "staticcascadingreels3x5.h"
 #include "symbolblock.h"
+#include "symbolblock2.h"
 #include "utils.h"
 
 namespace natasha {
@@ -24,6 +26,7 @@ typedef Lines<5, int> Lines3X5;
 typedef Lines3X5::LineInfoT LineInfo3X5;
 typedef SymbolBlock<int, 5, 3> SymbolBlock3X5;
 typedef NormalReels<SymbolType, 5, 3> NormalReels3X5;
+typedef NormalReelsSet<NormalReels3X5> NormalReelsSet3X5;
 
 typedef std::function<SymbolType(int, int, SymbolType)> FuncOnFillReels;
 
@@ -42,6 +45,148 @@ void randomReels3x5(const NormalReels3X5& reels,
                     const ::natashapb::UserGameModInfo* pUGMI,
                     FuncOnFillReels onfillreels);
 
+// getReelsSetIndex3x5 - the index of NormalReelsSet3X5 in RandomResult,
+//                       -1 if none
+int getReelsSetIndex3x5(const ::natashapb::RandomResult& rr);
+
+// setReelsSetIndex3x5 - save the index of NormalReelsSet3X5 in RandomResult
+void setReelsSetIndex3x5(::natashapb::RandomResult* pRandomResult, int ri);
+
+// randomReels3x5 - random normal reels, the reels is chosen from set by weight
+void randomReels3x5(const NormalReelsSet3X5& set,
+                    ::natashapb::RandomResult* pRandomResult,
+                    const ::natashapb::UserGameModInfo* pUGMI,
+                    FuncOnFillReels onfillreels);
+
+// _getFillReels3x5 - random new reels and return NULL, or return the
+//                    NormalReelsRandomResult3X5 need to fill
+::natashapb::NormalReelsRandomResult3X5* _getFillReels3x5(
+    const NormalReels3X5& reels, ::natashapb::RandomResult* pRandomResult,
+    const ::natashapb::UserGameModInfo* pUGMI);
+
+// FillIdentity - fill policy, keep the symbol of reels
+struct FillIdentity {
+  SymbolType onFill(int x, int y, SymbolType s) const { return s; }
+};
+
+// FillFunc - fill policy with FuncOnFillReels
+struct FillFunc {
+  const FuncOnFillReels& func;
+
+  explicit FillFunc(const FuncOnFillReels& f) : func(f) {}
+
+  SymbolType onFill(int x, int y, SymbolType s) const { return func(x, y, s); }
+};
+
+// fillReels3x5T - fill with NormalReels, FillPolicy::onFill is inlined
+//   FillPolicy - SymbolType onFill(int x, int y, SymbolType s)
+template <class FillPolicy>
+void fillReels3x5T(const NormalReels3X5& reels,
+                   const ::natashapb::SymbolBlock3X5& last3x5,
+                   ::natashapb::NormalReelsRandomResult3X5* pNRRR,
+                   const FillPolicy& policy) {
+  assert(pNRRR->reelsindex_size() == 5);
+
+  ::natashapb::SymbolBlock3X5* pSB35 =
+      pNRRR->mutable_symbolblock()->mutable_sb3x5();
+
+  for (int y = 2; y >= 0; --y) {
+    for (int x = 0; x < 5; ++x) {
+      auto curs = getSymbolBlock3X5(&last3x5, x, y);
+      if (curs == -1) {
+        auto ci = pNRRR->reelsindex(x) - 1;
+        auto cs = reels.getSymbolEx(x, ci);
+
+        setSymbolBlock3X5(pSB35, x, y, policy.onFill(x, y, cs));
+
+        pNRRR->set_reelsindex(x, ci);
+      } else {
+        setSymbolBlock3X5(pSB35, x, y, curs);
+      }
+    }
+  }
+}
+
+// fillReels3x5Batch - fill with NormalReels, draw all the random numbers of
+//                     the refilled cells in one randomScaleArray, then apply
+//                     them
+//   BatchPolicy - bool needRandom(int x, int y, SymbolType s)
+//               - uint32_t getRandomRange()
+//               - SymbolType onRandom(int x, int y, SymbolType s, uint32_t cr)
+//   分布和 fillReels3x5T 一样，但随机数是一次取的，同一个 seed 结果不同
+template <class BatchPolicy>
+void fillReels3x5Batch(const NormalReels3X5& reels,
+                       const ::natashapb::SymbolBlock3X5& last3x5,
+                       ::natashapb::NormalReelsRandomResult3X5* pNRRR,
+                       const BatchPolicy& policy) {
+  assert(pNRRR->reelsindex_size() == 5);
+
+  SymbolType lst[15];
+  int lstRandomPos[15];
+  uint32_t lstRandom[15];
+  int nums = 0;
+
+  // first, the symbols from reels
+  for (int y = 2; y >= 0; --y) {
+    for (int x = 0; x < 5; ++x) {
+      auto curs = getSymbolBlock3X5(&last3x5, x, y);
+      if (curs == -1) {
+        auto ci = pNRRR->reelsindex(x) - 1;
+        curs = reels.getSymbolEx(x, ci);
+
+        pNRRR->set_reelsindex(x, ci);
+
+        if (policy.needRandom(x, y, curs)) {
+          lstRandomPos[nums++] = y * 5 + x;
+        }
+      }
+
+      lst[y * 5 + x] = curs;
+    }
+  }
+
+  // one batch of random numbers
+  randomScaleArray(lstRandom, nums, policy.getRandomRange());
+
+  for (int i = 0; i < nums; ++i) {
+    int pos = lstRandomPos[i];
+    lst[pos] = policy.onRandom(pos % 5, pos / 5, lst[pos], lstRandom[i]);
+  }
+
+  ::natashapb::SymbolBlock3X5* pSB35 =
+      pNRRR->mutable_symbolblock()->mutable_sb3x5();
+
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 5; ++x) {
+      setSymbolBlock3X5(pSB35, x, y, lst[y * 5 + x]);
+    }
+  }
+}
+
+// randomReels3x5T - random normal reels, with a fill policy
+template <class FillPolicy>
+void randomReels3x5T(const NormalReels3X5& reels,
+                     ::natashapb::RandomResult* pRandomResult,
+                     const ::natashapb::UserGameModInfo* pUGMI,
+                     const FillPolicy& policy) {
+  auto pNRRR = _getFillReels3x5(reels, pRandomResult, pUGMI);
+  if (pNRRR != NULL) {
+    fillReels3x5T(reels, pUGMI->symbolblock().sb3x5(), pNRRR, policy);
+  }
+}
+
+// randomReels3x5Batch - random normal reels, with a batch fill policy
+template <class BatchPolicy>
+void randomReels3x5Batch(const NormalReels3X5& reels,
+                         ::natashapb::RandomResult* pRandomResult,
+                         const ::natashapb::UserGameModInfo* pUGMI,
+                         const BatchPolicy& policy) {
+  auto pNRRR = _getFillReels3x5(reels, pRandomResult, pUGMI);
+  if (pNRRR != NULL) {
+    fillReels3x5Batch(reels, pUGMI->symbolblock().sb3x5(), pNRRR, policy);
+  }
+}
+
 // loadPaytables3X5 - load paytables.csv
 void loadPaytables3X5(const char* fn, Paytables3X5& paytables);
 
@@ -63,9 +208,21 @@ void loadPaytables3X5FromPB(Paytables3X5& paytables,
 // loadLines3X5FromPB - load from protobuf
 void loadLines3X5FromPB(Lines3X5& lines, const natashapb::Lines* pLines);
 
-// loadNormalReels - reelstrips.csv
+// loadNormalReels - reelstrips.csv, W1 - W5 are the optional stop weights
 void loadNormalReels3X5(const char* fn, NormalReels3X5& scr);
 
+// loadNormalReelsSet3X5 - reelsset.csv, reels is the filename in cfgpath,
+//                         weight is the weight of the reels
+void loadNormalReelsSet3X5(const char* cfgpath, const char* fn,
+                           NormalReelsSet3X5& set);
+
+// loadNormalReelsSet3X5FromPB - lstfn[i] is the reels, weight is
+//                               cfg.weights(i)
+void loadNormalReelsSet3X5FromPB(const char* cfgpath,
+                                 const FileNameList& lstfn,
+                                 const ::natashapb::WeightConfig& cfg,
+                                 NormalReelsSet3X5& set);
+
 // pb::SymbolBlock3X5 -> SymbolBlock3X5
 inline void setSymbolBlock5X3FromProtoc(
     SymbolBlock3X5& dest, const natashapb::SymbolBlock3X5& sb3x5) {
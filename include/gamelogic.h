@@ -8,6 +8,10 @@
 #include "../protoc/base.pb.h"
 #include "array.h"
 #include "gamemod.h"
+#include "randomjournal.h"
+#ifdef NATASHA_SIMULATION
+#include "randomreplay.h"
+#endif  // NATASHA_SIMULATION
 #include "rtp.h"
 #include "userinfo.h"
 #include "utils.h"
@@ -17,6 +21,19 @@ namespace natasha {
 typedef std::function< ::natashapb::CODE(::natashapb::UserGameLogicInfo*)>
     FuncProcGameCtrlResult;
 
+// max nums of gamectrl in resolveGameCtrl, a feature never ends after it
+const int MAX_RESOLVE_GAMECTRL_NUMS = 10000;
+
+// ResolvedStep - compact result of one gamectrl in resolveGameCtrl
+//              - 给客户端播动画用
+struct ResolvedStep {
+  ::natashapb::GAMEMODTYPE module;
+  CtrlID ctrlid;
+  ScenarioStep step;
+};
+
+typedef std::vector<ResolvedStep> ResolvedStepList;
+
 class GameLogic {
  public:
   typedef std::map< ::natashapb::GAMEMODTYPE, GameMod*> MapGameMod;
@@ -34,6 +51,37 @@ class GameLogic {
   virtual ::natashapb::CODE gameCtrl(::natashapb::GameCtrl* pGameCtrl,
                                      UserInfo* pUser);
 
+  // resolveGameCtrl - gamectrl, then all the cascades & free spins after it
+  //                   until iscompleted
+  //                 - pGameCtrl 必须是 spin，free spin 用同样的 bet
+  //                 - FuncProcGameCtrlResult 只在最后调用一次
+  //                 - 中途失败（包括超过 MAX_RESOLVE_GAMECTRL_NUMS）时，
+  //                   pLogicUser、lstStep 和 pLstSpinResult 都恢复到调用前，
+  //                   FuncProcGameCtrlResult 不调用，
+  //                   NATASHA_COUNTRTP 的统计不恢复
+  //                 - pLstSpinResult 可以为 NULL
+  ::natashapb::CODE resolveGameCtrl(
+      ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser,
+      ResolvedStepList& lstStep,
+      ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+          pLstSpinResult);
+
+  // gameCtrlWithJournal - gameCtrl, and all draws of it in journal
+  //                     - journal 先 clear，和这一局的记录一起保存，
+  //                       审计时用 replayGameCtrl 重放
+  ::natashapb::CODE gameCtrlWithJournal(::natashapb::GameCtrl* pGameCtrl,
+                                        UserInfo* pUser,
+                                        RandomJournal& journal);
+
+#ifdef NATASHA_SIMULATION
+  // replayGameCtrl - gameCtrl with the draws of replay instead of the rng
+  //                - pUser 必须是这一局开始前的状态
+  //                - 返回 OK 以后还要检查 replay.isFinished()，
+  //                  不是的话这一局和记录对不上
+  ::natashapb::CODE replayGameCtrl(::natashapb::GameCtrl* pGameCtrl,
+                                   UserInfo* pUser, RandomReplay& replay);
+#endif  // NATASHA_SIMULATION
+
   // getMainGameMod - get current main game module
   virtual GameMod* getMainGameMod(UserInfo* pUser, bool isComeInGame);
 
@@ -43,11 +91,40 @@ class GameLogic {
       const ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser, GameMod* curmod,
       ::natashapb::UserGameModInfo* curugmi);
 
+ protected:
+  // procGameCtrl - gamectrl without FuncProcGameCtrlResult
+  ::natashapb::CODE procGameCtrl(::natashapb::GameCtrl* pGameCtrl,
+                                 UserInfo* pUser);
+
+  // procResolveGameCtrl - resolveGameCtrl without FuncProcGameCtrlResult and
+  //                       without restore
+  ::natashapb::CODE procResolveGameCtrl(
+      ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser,
+      ResolvedStepList& lstStep,
+      ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+          pLstSpinResult);
+
  public:
   // addGameMod - init game module
   //   Only for init
   ::natashapb::CODE addGameMod(::natashapb::GAMEMODTYPE gmt, GameMod* pMod);
 
+  // buildInitScenarios - build initial scenarios index for game module
+  //   Only for init
+  ::natashapb::CODE buildInitScenarios(::natashapb::GAMEMODTYPE gmt,
+                                       void* pCurConfig);
+
+  // releaseInitScenarios - release initial scenarios index for game module
+  //   Only for init
+  void releaseInitScenarios(::natashapb::GAMEMODTYPE gmt,
+                            const void* pCurConfig);
+
+  // buildScenarioOutcomes - build scenario outcomes for game module
+  //   Only for init
+  ::natashapb::CODE buildScenarioOutcomes(
+      ::natashapb::GAMEMODTYPE gmt, void* pCurConfig,
+      const ::natashapb::GameCtrl* pGameCtrl);
+
   // getGameMod - get game module
   GameMod* getGameMod(::natashapb::GAMEMODTYPE gmt);
 
@@ -92,6 +169,18 @@ class GameLogic {
     m_rtp.addPayout(module, payout);
   }
 
+  // onRTPSpinResult - count the spin result of module, after gamectrl
+  //                 - 都是 const 引用，不复制 SpinResult
+  void onRTPSpinResult(::natashapb::GAMEMODTYPE module,
+                       const ::natashapb::SpinResult& spinret,
+                       const ::natashapb::UserGameModInfo* pUser) {
+    for (int i = 0; i < spinret.lstgri_size(); ++i) {
+      onRTPAddPayoutGRI(module, spinret, spinret.lstgri(i), pUser);
+    }
+
+    m_rtp.addPayout(module, spinret.realwin());
+  }
+
   virtual void onRTPAddPayoutGRI(::natashapb::GAMEMODTYPE module,
                                  const ::natashapb::SpinResult& spinret,
                                  const ::natashapb::GameResultInfo& gri,
@@ -6,6 +6,7 @@
 #include <vector>
 #include "../protoc/base.pb.h"
 #include "array.h"
+#include "profile.h"
 #include "userinfo.h"
 #include "utils.h"
 
@@ -13,6 +14,40 @@ namespace natasha {
 
 class GameLogic;
 
+// ScenarioStep - compact result of one step in the cascade
+struct ScenarioStep {
+  MoneyType win;
+  MoneyType realWin;
+  int32_t awardMul;
+  int32_t fgNums;
+  int32_t griNums;
+};
+
+typedef std::vector<ScenarioStep> ScenarioStepList;
+
+// buildScenarioStep - SpinResult -> ScenarioStep
+inline void buildScenarioStep(const ::natashapb::SpinResult& spinret,
+                              ScenarioStep& step) {
+  step.win = spinret.win();
+  step.realWin = spinret.realwin();
+  step.awardMul = spinret.awardmul();
+  step.fgNums = spinret.realfgnums();
+  step.griNums = spinret.lstgri_size();
+}
+
+// ScenarioOutcome - outcome of the whole cascade of a scenario
+//                 - 金额是 gamectrl 里的 bet 的倍数
+struct ScenarioOutcome {
+  MoneyType totalWin;
+  // cascadeNums - nums of steps
+  int cascadeNums;
+  // fgNums - realfgnums of all steps
+  int fgNums;
+  ScenarioStepList lstStep;
+};
+
+typedef std::vector<ScenarioOutcome> ScenarioOutcomeList;
+
 class GameMod {
  public:
   GameMod(GameLogic& logic, ::natashapb::GAMEMODTYPE gmt)
@@ -89,6 +124,21 @@ class GameMod {
     return ::natashapb::ERR_NO_OVERLOADED_INTERFACE;
   }
 
+  // buildInitScenarios - build the initial scenarios index for user config
+  //                    - 预先生成不中奖的初始局面，makeInitScenario直接从里面随机
+  virtual ::natashapb::CODE buildInitScenarios(const UserInfo* pUser) {
+    return ::natashapb::ERR_NO_OVERLOADED_INTERFACE;
+  }
+
+  // releaseInitScenarios - release the initial scenarios for user config
+  virtual void releaseInitScenarios(const UserInfo* pUser) {}
+
+  // buildScenarioOutcomes - resolve every scenario to the end of cascade
+  virtual ::natashapb::CODE buildScenarioOutcomes(
+      const UserInfo* pUser, const ::natashapb::GameCtrl* pGameCtrl) {
+    return ::natashapb::ERR_NO_OVERLOADED_INTERFACE;
+  }
+
  public:
   // getGameModType - get GAMEMODTYPE
   ::natashapb::GAMEMODTYPE getGameModType() { return m_gmt; }
@@ -107,7 +157,10 @@ class SlotsGameMod : public GameMod {
  public:
   SlotsGameMod(GameLogic& logic, ::natashapb::GAMEMODTYPE gmt)
       : GameMod(logic, gmt) {}
-  virtual ~SlotsGameMod() {}
+  virtual ~SlotsGameMod() {
+    clearInitScenarios();
+    clearScenarioOutcomes();
+  }
 
  public:
   // onGameCtrl
@@ -121,36 +174,58 @@ class SlotsGameMod : public GameMod {
 
     // auto pLogicUser = pUser->pLogicUser;
 
-    auto code = this->onSpinStart(pMainUGMI, pGameCtrl, pUser);
-    if (code != ::natashapb::OK) {
-      return code;
+    ::natashapb::CODE code;
+
+    {
+      NATASHA_PROFILE_SCOPE(PROFILE_ONSPINSTART);
+
+      code = this->onSpinStart(pMainUGMI, pGameCtrl, pUser);
+      if (code != ::natashapb::OK) {
+        return code;
+      }
     }
 
-    code = this->randomReels(pMainUGMI->mutable_randomresult(), pGameCtrl,
-                             pMainUGMI, pUser);
-    if (code != ::natashapb::OK) {
-      return code;
+    {
+      NATASHA_PROFILE_SCOPE(PROFILE_RANDOMREELS);
+
+      code = this->randomReels(pMainUGMI->mutable_randomresult(), pGameCtrl,
+                               pMainUGMI, pUser);
+      if (code != ::natashapb::OK) {
+        return code;
+      }
     }
 
-    code = this->countSpinResult(pMainUGMI->mutable_spinresult(), pGameCtrl,
-                                 pMainUGMI->mutable_randomresult(), pMainUGMI,
-                                 pUser);
-    if (code != ::natashapb::OK) {
-      return code;
+    {
+      NATASHA_PROFILE_SCOPE(PROFILE_COUNTSPINRESULT);
+
+      code = this->countSpinResult(pMainUGMI->mutable_spinresult(), pGameCtrl,
+                                   pMainUGMI->mutable_randomresult(),
+                                   pMainUGMI, pUser);
+      if (code != ::natashapb::OK) {
+        return code;
+      }
     }
 
-    code = this->procSpinResult(pMainUGMI, pGameCtrl,
-                                pMainUGMI->mutable_spinresult(),
-                                pMainUGMI->mutable_randomresult(), pUser);
-    if (code != ::natashapb::OK) {
-      return code;
+    {
+      NATASHA_PROFILE_SCOPE(PROFILE_PROCSPINRESULT);
+
+      code = this->procSpinResult(pMainUGMI, pGameCtrl,
+                                  pMainUGMI->mutable_spinresult(),
+                                  pMainUGMI->mutable_randomresult(), pUser);
+      if (code != ::natashapb::OK) {
+        return code;
+      }
     }
 
-    code =
-        this->onSpinEnd(pMainUGMI, pGameCtrl, pMainUGMI->mutable_spinresult(),
-                        pMainUGMI->mutable_randomresult(), pUser);
-    if (code != ::natashapb::OK) {
-      return code;
+    {
+      NATASHA_PROFILE_SCOPE(PROFILE_ONSPINEND);
+
+      code = this->onSpinEnd(pMainUGMI, pGameCtrl,
+                             pMainUGMI->mutable_spinresult(),
+                             pMainUGMI->mutable_randomresult(), pUser);
+      if (code != ::natashapb::OK) {
+        return code;
+      }
     }
 
     return ::natashapb::OK;
@@ -176,10 +251,39 @@ class SlotsGameMod : public GameMod {
 
   // makeInitScenario - make a initial scenario
   //                  - 产生一个初始局面，不中奖的
+  //                  - 只有 buildInitScenarios 过的 config 一定成功，
+  //                    其它的还是随机重试，可能返回 ERR_MAKE_INITIAL_SCENARIO
   virtual ::natashapb::CODE makeInitScenario(
       ::natashapb::GameCtrl* pGameCtrl, const UserInfo* pUser,
       ::natashapb::UserGameModInfo* pUGMI);
 
+  // buildInitScenarios - build the initial scenarios index for user config
+  //                    - 预先生成不中奖的初始局面，makeInitScenario直接从里面随机
+  //                    - 能枚举的 reels 是全部不中奖的 scenario，分布是准确的；
+  //                      不能枚举的只是 MAX_NUMS_BUILDINITSCENARIO 次采样里
+  //                      不中奖的那些，是一个固定的池子，不是真实的分布
+  virtual ::natashapb::CODE buildInitScenarios(const UserInfo* pUser);
+
+  // releaseInitScenarios - release the initial scenarios for user config
+  //                      - 之后 makeInitScenario 对这个 config 会随机重试
+  virtual void releaseInitScenarios(const UserInfo* pUser);
+
+  // buildScenarioOutcomes - resolve every scenario to the end of cascade
+  //                       - 只有能枚举的 reels 才可以
+  virtual ::natashapb::CODE buildScenarioOutcomes(
+      const UserInfo* pUser, const ::natashapb::GameCtrl* pGameCtrl);
+
+  // getScenarioNums - nums of all the scenarios, 0 means can not be
+  //                       enumerated, buildInitScenarios will sample it
+  virtual int getScenarioNums(const UserInfo* pUser) { return 0; }
+
+  // setScenario - set the index-th scenario to random result
+  virtual ::natashapb::CODE setScenario(
+      ::natashapb::RandomResult* pRandomResult, int index,
+      const UserInfo* pUser) {
+    return ::natashapb::ERR_NO_OVERLOADED_INTERFACE;
+  }
+
  public:
   // randomReels - random reels
   virtual ::natashapb::CODE randomReels(
@@ -229,7 +333,50 @@ class SlotsGameMod : public GameMod {
                                      int64_t realWin, int64_t win, int64_t mul,
                                      bool isSpecial);
 
+  // clearInitScenarios
+  void clearInitScenarios();
+
+  // getInitScenarioNums - nums of the initial scenarios for user config
+  int getInitScenarioNums(const UserInfo* pUser) const;
+
+  // resolveScenario - resolve the index-th scenario to the end of cascade
+  //                 - pLstSpinResult is NULL if no need to expand the steps
+  //                 - 需要播放动画时才展开每一步的 SpinResult
+  ::natashapb::CODE resolveScenario(
+      const UserInfo* pUser, const ::natashapb::GameCtrl* pGameCtrl, int index,
+      ScenarioOutcome& outcome,
+      ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+          pLstSpinResult);
+
+  // clearScenarioOutcomes
+  void clearScenarioOutcomes();
+
+  // getScenarioOutcomeNums - nums of the scenario outcomes for user config
+  int getScenarioOutcomeNums(const UserInfo* pUser) const;
+
+  // getScenarioOutcome - get the index-th scenario outcome, NULL if not found
+  const ScenarioOutcome* getScenarioOutcome(const UserInfo* pUser,
+                                            int index) const;
+
+  // randomScenarioOutcome - one random draw and a table read
+  //                       - 只适用于 scenario 是均匀随机的 reels
+  const ScenarioOutcome* randomScenarioOutcome(const UserInfo* pUser,
+                                               int& index) const;
+
  protected:
+  struct InitScenario {
+    ::natashapb::RandomResult randomResult;
+    ::natashapb::SpinResult spinResult;
+  };
+
+  typedef std::vector<InitScenario*> InitScenarioList;
+  typedef std::map<const void*, InitScenarioList*> MapInitScenario;
+
+  MapInitScenario m_mapInitScenario;
+
+  typedef std::map<const void*, ScenarioOutcomeList*> MapScenarioOutcome;
+
+  MapScenarioOutcome m_mapScenarioOutcome;
 };
 
 }  // namespace natasha
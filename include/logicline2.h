@@ -8,18 +8,20 @@
 #include "gameresult.h"
 #include "lines.h"
 #include "paytables.h"
+#include "resultcache.h"
 #include "symbolblock2.h"
+#include "symbolmask.h"
 #include "utils.h"
 
 namespace natasha {
 
+// _countLine_Left - only mul in gri, win = mul * bet in countAllLine_Left
 template <typename MoneyType, typename SymbolType, int Width, int Height,
           class SymbolBlockT, typename GameCfgT>
 bool _countLine_Left(
     ::natashapb::GameResultInfo& gri, const StaticArray<Width, SymbolType>& sl,
     int lineIndex, const typename Lines<Width, int>::LineInfoT& li,
-    const Paytables<Width, SymbolType, int, MoneyType>& paytables,
-    MoneyType bet) {
+    const Paytables<Width, SymbolType, int, MoneyType>& paytables) {
   typedef GameResultInfo<MoneyType, SymbolType, int, NullType> GameResultInfoT;
   //   typedef SymbolBlock<SymbolType, Width, Height> SymbolBlockT;
   typedef Lines<Width, int> LinesT;
@@ -57,8 +59,6 @@ bool _countLine_Left(
     gri.set_mul(p);
     gri.set_symbol(s0);
     gri.set_typegameresult(::natashapb::LINE_LEFT);
-    gri.set_win(bet * p);
-    gri.set_realwin(gri.win());
     gri.set_lineindex(lineIndex);
 
     return true;
@@ -93,15 +93,162 @@ void countAllLine_Left(
 
     bool iswin =
         _countLine_Left<MoneyType, SymbolType, Width, Height, SymbolBlockT,
-                        GameCfgT>(gri, sl, i, lines.get(i), paytables, bet);
+                        GameCfgT>(gri, sl, i, lines.get(i), paytables);
     if (iswin) {
       auto curgri = sr.add_lstgri();
       curgri->CopyFrom(gri);
+      curgri->set_win(bet * gri.mul());
+      curgri->set_realwin(curgri->win());
+
+      sr.set_win(sr.win() + curgri->win());
+      sr.set_realwin(sr.realwin() + curgri->realwin());
+    }
+  }
+}
+
+// countAllLine_Left_Cache - countAllLine_Left with BoardResultCache
+//                         - pCache 为 NULL 时和 countAllLine_Left 一样
+template <typename MoneyType, typename SymbolType, int Width, int Height,
+          typename SymbolBlockT, typename GameCfgT>
+void countAllLine_Left_Cache(
+    ::natashapb::SpinResult& sr, const SymbolBlockT& arr,
+    const Lines<Width, int>& lines,
+    const Paytables<Width, SymbolType, int, MoneyType>& paytables,
+    MoneyType bet, BoardResultCache<SymbolBlockT, Width, Height>* pCache) {
+  if (pCache == NULL) {
+    countAllLine_Left<MoneyType, SymbolType, Width, Height, SymbolBlockT,
+                      GameCfgT>(sr, arr, lines, paytables, bet);
+
+    return;
+  }
+
+  auto win = countWithResultCache(
+      *pCache, sr, arr, bet, [&](::natashapb::SpinResult& unit) {
+        for (int i = 0; i < lines.getNums(); ++i) {
+          StaticArray<Width, SymbolType> sl;
 
-      sr.set_win(sr.win() + gri.win());
-      sr.set_realwin(sr.realwin() + gri.realwin());
+          buildSymbolLine<SymbolBlockT, Width, Height>(&arr, sl, lines, i);
+
+          ::natashapb::GameResultInfo gri;
+
+          bool iswin =
+              _countLine_Left<MoneyType, SymbolType, Width, Height,
+                              SymbolBlockT, GameCfgT>(gri, sl, i,
+                                                      lines.get(i), paytables);
+          if (iswin) {
+            unit.add_lstgri()->Swap(&gri);
+          }
+        }
+      });
+
+  sr.set_win(sr.win() + win);
+  sr.set_realwin(sr.realwin() + win);
+}
+
+// _isCleanLine_Left - is the result of line li on masks the same as on the
+//                     board of prev
+//                   - 只看算到的那几格：断开的那一格变了，但前后都连不上也算没变
+template <int Width, class SymbolMaskT, class PrevBoardResultT,
+          typename GameCfgT>
+bool _isCleanLine_Left(const SymbolMaskT& masks, const PrevBoardResultT& prev,
+                       const typename Lines<Width, int>::LineInfoT& li) {
+  int i0 = SymbolMaskT::getIndex(0, li.get(0));
+  if (prev.isDirty(i0)) {
+    return false;
+  }
+
+  SymbolType s0 = masks.getSymbol(i0);
+
+  for (int x = 1; x < Width; ++x) {
+    int i = SymbolMaskT::getIndex(x, li.get(x));
+    SymbolType cs = masks.getSymbol(i);
+
+    if (prev.isDirty(i)) {
+      return !GameCfgT::isSameSymbol_OnLine(s0, cs) &&
+             !GameCfgT::isSameSymbol_OnLine(s0, prev.masks.getSymbol(i));
+    }
+
+    if (!GameCfgT::isSameSymbol_OnLine(s0, cs)) {
+      return true;
     }
   }
+
+  return true;
+}
+
+// _buildWinLine_Left - build the symbol line of li from masks, returns false
+//                      if it can not win
+template <typename MoneyType, typename SymbolType, int Width,
+          class SymbolMaskT, typename GameCfgT>
+bool _buildWinLine_Left(
+    StaticArray<Width, SymbolType>& sl, const SymbolMaskT& masks,
+    const typename Lines<Width, int>::LineInfoT& li,
+    const Paytables<Width, SymbolType, int, MoneyType>& paytables) {
+  for (int x = 0; x < Width; ++x) {
+    sl.set(x, masks.getSymbol(SymbolMaskT::getIndex(x, li.get(x))));
+  }
+
+  SymbolType s0 = sl.get(0);
+  int nums = 1;
+  while (nums < Width && GameCfgT::isSameSymbol_OnLine(s0, sl.get(nums))) {
+    ++nums;
+  }
+
+  return paytables.getSymbolPayout(s0, nums - 1) > 0;
+}
+
+// countAllLine_Left_Dirty - countAllLine_Left after a cascade step, the lines
+//                           not changed since prev are copied from prev
+//                         - masks 是 arr 的，prev 见 PrevBoardResult
+template <typename MoneyType, typename SymbolType, int Width, int Height,
+          typename SymbolBlockT, typename GameCfgT, class SymbolMaskT>
+void countAllLine_Left_Dirty(
+    ::natashapb::SpinResult& sr, const SymbolBlockT& arr,
+    const SymbolMaskT& masks,
+    const PrevBoardResult<SymbolBlockT, SymbolMaskT>& prev,
+    const Lines<Width, int>& lines,
+    const Paytables<Width, SymbolType, int, MoneyType>& paytables,
+    MoneyType bet) {
+  assert(prev.pResult != NULL);
+
+  int begin = sr.lstgri_size();
+
+  for (int i = 0; i < lines.getNums(); ++i) {
+    if (_isCleanLine_Left<Width, SymbolMaskT,
+                          PrevBoardResult<SymbolBlockT, SymbolMaskT>,
+                          GameCfgT>(masks, prev, lines.get(i))) {
+      for (int j = 0; j < prev.pResult->lstgri_size(); ++j) {
+        const auto& prevgri = prev.pResult->lstgri(j);
+        if (prevgri.typegameresult() == ::natashapb::LINE_LEFT &&
+            prevgri.lineindex() == i) {
+          sr.add_lstgri()->CopyFrom(prevgri);
+        }
+      }
+
+      continue;
+    }
+
+    // 变了的线先在 masks 上算，不中奖就不用写 gri
+    StaticArray<Width, SymbolType> sl;
+    if (!_buildWinLine_Left<MoneyType, SymbolType, Width, SymbolMaskT,
+                            GameCfgT>(sl, masks, lines.get(i), paytables)) {
+      continue;
+    }
+
+    ::natashapb::GameResultInfo gri;
+
+    bool iswin =
+        _countLine_Left<MoneyType, SymbolType, Width, Height, SymbolBlockT,
+                        GameCfgT>(gri, sl, i, lines.get(i), paytables);
+    if (iswin) {
+      sr.add_lstgri()->Swap(&gri);
+    }
+  }
+
+  auto win = applyBetToGameResult(sr, begin, bet);
+
+  sr.set_win(sr.win() + win);
+  sr.set_realwin(sr.realwin() + win);
 }
 
 }  // namespace natasha
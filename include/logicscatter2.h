@@ -9,6 +9,7 @@
 #include "lines.h"
 #include "paytables.h"
 #include "symbolblock2.h"
+#include "symbolmask.h"
 #include "utils.h"
 
 namespace natasha {
@@ -62,6 +63,56 @@ bool countScatter_Left(
   return false;
 }
 
+// countScatter_Left_Mask - countScatter_Left with the masks of the board
+//                        - 先用 popcount 算数量，中奖了才写 lstpos 和 lstsymbol，
+//                          所以没中奖时 gri 里没有位置
+template <typename MoneyType, typename SymbolType, int Width, int Height,
+          class SymbolMaskT, typename GameCfgT>
+bool countScatter_Left_Mask(
+    ::natashapb::GameResultInfo& gri, const SymbolMaskT& masks,
+    const Paytables<Width, SymbolType, int, MoneyType>& paytables, SymbolType s,
+    MoneyType totalbet) {
+  clearGameResultInfo(gri);
+  gri.set_symbol(s);
+
+  BoardMask mask = 0;
+  for (SymbolType cs = 0; cs < SymbolMaskT::SymbolNums; ++cs) {
+    if (GameCfgT::isScatter(cs)) {
+      mask |= masks.getMask(cs);
+    }
+  }
+
+  int snums = countBoardMask(mask);
+  if (snums > GameCfgT::getMaxScstterNums(s)) {
+    snums = GameCfgT::getMaxScstterNums(s);
+  }
+
+  if (snums < 1) {
+    return false;
+  }
+
+  MoneyType p = paytables.getSymbolPayout(s, snums - 1);
+  if (p > 0) {
+    while (mask != 0) {
+      int i = popBoardMask(mask);
+
+      auto pos = gri.add_lstpos();
+      pos->set_x(SymbolMaskT::getX(i));
+      pos->set_y(SymbolMaskT::getY(i));
+
+      gri.add_lstsymbol(masks.getSymbol(i));
+    }
+
+    gri.set_typegameresult(::natashapb::SCATTER_LEFT);
+    gri.set_win(totalbet * p);
+    gri.set_realwin(gri.win());
+
+    return true;
+  }
+
+  return false;
+}
+
 }  // namespace natasha
 
 #endif  // __NATASHA_LOGICSCATTER2_H__
\ No newline at end of file
@@ -8,16 +8,19 @@
 #include "gameresult.h"
 #include "lines.h"
 #include "paytables.h"
+#include "resultcache.h"
 #include "symbolblock2.h"
 #include "utils.h"
 
 namespace natasha {
 
+// _countFullWays5_Left - only mul in lstgri, without bet & sr.win
+//                       - 用 applyBetToGameResult 乘 bet
 template <typename MoneyType, typename SymbolType, int Height,
           class SymbolBlockT, typename GameCfgT>
 bool _countFullWays5_Left(
     ::natashapb::SpinResult& sr, SymbolType s, int y0, const SymbolBlockT& arr,
-    const Paytables<5, SymbolType, int, MoneyType>& paytables, MoneyType bet) {
+    const Paytables<5, SymbolType, int, MoneyType>& paytables) {
   typedef GameResultInfo<MoneyType, SymbolType, int, NullType> GameResultInfoT;
   typedef Paytables<5, SymbolType, int, MoneyType> PaytablesT;
 
@@ -57,10 +60,6 @@ bool _countFullWays5_Left(
                     curgri->set_mul(p);
                     curgri->set_symbol(s);
                     curgri->set_typegameresult(::natashapb::WAY_LEFT);
-                    curgri->set_win(bet * p);
-                    curgri->set_realwin(curgri->win());
-
-                    sr.set_win(sr.win() + curgri->win());
 
                     auto pos0 = curgri->add_lstpos();
                     pos0->set_x(0);
@@ -104,10 +103,6 @@ bool _countFullWays5_Left(
                   curgri->set_mul(p);
                   curgri->set_symbol(s);
                   curgri->set_typegameresult(::natashapb::WAY_LEFT);
-                  curgri->set_win(bet * p);
-                  curgri->set_realwin(curgri->win());
-
-                  sr.set_win(sr.win() + curgri->win());
 
                   auto pos0 = curgri->add_lstpos();
                   pos0->set_x(0);
@@ -147,10 +142,6 @@ bool _countFullWays5_Left(
               curgri->set_mul(p);
               curgri->set_symbol(s);
               curgri->set_typegameresult(::natashapb::WAY_LEFT);
-              curgri->set_win(bet * p);
-              curgri->set_realwin(curgri->win());
-
-              sr.set_win(sr.win() + curgri->win());
 
               auto pos0 = curgri->add_lstpos();
               pos0->set_x(0);
@@ -183,10 +174,6 @@ bool _countFullWays5_Left(
           curgri->set_mul(p);
           curgri->set_symbol(s);
           curgri->set_typegameresult(::natashapb::WAY_LEFT);
-          curgri->set_win(bet * p);
-          curgri->set_realwin(curgri->win());
-
-          sr.set_win(sr.win() + curgri->win());
 
           auto pos0 = curgri->add_lstpos();
           pos0->set_x(0);
@@ -420,6 +407,8 @@ void countFullWays5_Left(
   typedef Paytables<5, SymbolType, int, MoneyType> PaytablesT;
   typedef GameResultInfo<MoneyType, SymbolType, int, NullType> GameResultInfoT;
 
+  int begin = sr.lstgri_size();
+
   for (int i = 0; i < Height; ++i) {
     auto curs = getSymbolBlock<SymbolBlockT, 5, Height>(&arr, 0, i);
     // if (GameCfgT::isWild(curs)) {
@@ -427,11 +416,41 @@ void countFullWays5_Left(
     //                             GameCfgT>(sr, curs, i, arr, paytables, bet);
     // } else {
     _countFullWays5_Left<MoneyType, SymbolType, Height, SymbolBlockT, GameCfgT>(
-        sr, curs, i, arr, paytables, bet);
+        sr, curs, i, arr, paytables);
     // }
 
     // printf("countFullWays5_Left %lld %d\n", sr.win(), sr.lstgri_size());
   }
+
+  sr.set_win(sr.win() + applyBetToGameResult(sr, begin, bet));
+}
+
+// countFullWays5_Left_Cache - countFullWays5_Left with BoardResultCache
+//                           - pCache 为 NULL 时和 countFullWays5_Left 一样
+template <typename MoneyType, typename SymbolType, int Height,
+          typename SymbolBlockT, typename GameCfgT>
+void countFullWays5_Left_Cache(
+    ::natashapb::SpinResult& sr, const SymbolBlockT& arr,
+    const Paytables<5, SymbolType, int, MoneyType>& paytables, MoneyType bet,
+    BoardResultCache<SymbolBlockT, 5, Height>* pCache) {
+  if (pCache == NULL) {
+    countFullWays5_Left<MoneyType, SymbolType, Height, SymbolBlockT, GameCfgT>(
+        sr, arr, paytables, bet);
+
+    return;
+  }
+
+  auto win = countWithResultCache(
+      *pCache, sr, arr, bet, [&](::natashapb::SpinResult& unit) {
+        for (int i = 0; i < Height; ++i) {
+          auto curs = getSymbolBlock<SymbolBlockT, 5, Height>(&arr, 0, i);
+
+          _countFullWays5_Left<MoneyType, SymbolType, Height, SymbolBlockT,
+                               GameCfgT>(unit, curs, i, arr, paytables);
+        }
+      });
+
+  sr.set_win(sr.win() + win);
 }
 
 }  // namespace natasha
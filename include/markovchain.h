@@ -0,0 +1,51 @@
+#ifndef __NATASHA_MARKOVCHAIN_H__
+#define __NATASHA_MARKOVCHAIN_H__
+
+#include <assert.h>
+#include <vector>
+
+namespace natasha {
+
+// MarkovChain - absorbing markov chain with reward
+//   每个状态的出口概率之和 <= 1，不足 1 的部分就是进入吸收态（结束）
+class MarkovChain {
+ public:
+  struct Transition {
+    int to;
+    double p;
+  };
+
+  typedef std::vector<Transition> TransitionList;
+
+ public:
+  MarkovChain() {}
+  ~MarkovChain() {}
+
+ public:
+  // init - clear and resize
+  void init(int stateNums);
+
+  int getStateNums() const { return m_lstReward.size(); }
+
+  // addTransition - from -> to with probability p
+  void addTransition(int from, int to, double p);
+
+  // addReward - reward when leaving the state
+  void addReward(int state, double r);
+
+  // setReward - reward when leaving the state
+  void setReward(int state, double r);
+
+  // solve - expected total reward before absorption for every state
+  //       - Gauss-Seidel, return false if it does not converge
+  bool solve(std::vector<double>& lstValue, double eps = 1e-12,
+             int maxIterations = 100000) const;
+
+ protected:
+  std::vector<TransitionList> m_lstTransition;
+  std::vector<double> m_lstReward;
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_MARKOVCHAIN_H__
@@ -10,6 +10,7 @@
 #include "gamecode.h"
 #include "logicline2.h"
 #include "logicscatter2.h"
+#include "symboltable.h"
 #include "utils.h"
 #include "config.h"
 
@@ -17,6 +18,7 @@
 // #define NATASHA_COUNTRTP
 // #define NATASHA_RUNINCPP
 // #define NATASHA_DEBUG
+// #define NATASHA_PROFILE
 
 namespace natasha {
 
@@ -24,6 +26,12 @@ typedef std::vector<MoneyType> BetList;
 
 // max nums for makeInitScenario
 const int MAX_NUMS_MAKEINITIALSCENARIO = 200;
+// sample nums for buildInitScenarios, only for the reels can not be enumerated
+//   the initial scenarios are a fixed pool of these samples, not the real
+//   distribution of the reels
+const int MAX_NUMS_BUILDINITSCENARIO = 10000;
+// max steps of a cascade for resolveScenario
+const int MAX_NUMS_SCENARIOSTEP = 1000;
 
 }  // namespace natasha
 
@@ -3,14 +3,24 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "config.h"
+#include "fortuna.h"
 
 namespace natasha {
 
+// NormalReels - reels of Width columns, a window is Height symbols
+//             - 所有的轴在一块内存里，每个轴前后各有 Height 个绕回来的 symbol，
+//               [-Height, length + Height) 不用判断绕回
+//             - 所以每个停止位置 y 的窗口就是 getWindow(x, y) 开始的 Height 个
+//             - 停止位置默认是均匀的，setStopWeights 以后按权重
 template <typename SymbolType, int Width, int Height>
 class NormalReels {
  public:
  public:
-  NormalReels() {
+  NormalReels() : m_pBuff(NULL) {
     for (int i = 0; i < Width; ++i) {
       m_reels[i] = NULL;
       m_reelsLength[i] = 0;
@@ -25,34 +35,82 @@ class NormalReels {
 
  public:
   void release() {
-    for (int i = 0; i < Width; ++i) {
-      if (m_reels[i] != NULL) {
-        free(m_reels[i]);
+    if (m_pBuff != NULL) {
+      free(m_pBuff);
 
-        m_reels[i] = NULL;
-        m_reelsLength[i] = 0;
-      }
+      m_pBuff = NULL;
+    }
+
+    for (int i = 0; i < Width; ++i) {
+      m_reels[i] = NULL;
+      m_reelsLength[i] = 0;
+      m_lstStopWeight[i] = AliasTable();
     }
   }
 
+  // resetReelsLength - reset length of reel x, the other reels are kept
+  //                  - 重新分配整块内存，只在载入配置时调用
   void resetReelsLength(int x, int length) {
     assert(x >= 0 && x < Width);
     assert(length > 0 && length >= Height);
 
-    if (m_reels[x] != NULL) {
-      free(m_reels[x]);
+    int lstLength[Width];
+    int total = 0;
+    for (int i = 0; i < Width; ++i) {
+      lstLength[i] = i == x ? length : m_reelsLength[i];
+
+      if (lstLength[i] > 0) {
+        total += lstLength[i] + 2 * Height;
+      }
+    }
+
+    SymbolType* pBuff = (SymbolType*)malloc(sizeof(SymbolType) * total);
+    SymbolType* pCur = pBuff;
+
+    for (int i = 0; i < Width; ++i) {
+      if (lstLength[i] <= 0) {
+        m_reels[i] = NULL;
+
+        continue;
+      }
+
+      if (i != x) {
+        memcpy(pCur, m_reels[i] - Height,
+               sizeof(SymbolType) * (lstLength[i] + 2 * Height));
+      }
+
+      m_reels[i] = pCur + Height;
+      m_reelsLength[i] = lstLength[i];
+
+      if (i == x) {
+        m_lstStopWeight[i] = AliasTable();
+      }
+
+      pCur += lstLength[i] + 2 * Height;
+    }
+
+    if (m_pBuff != NULL) {
+      free(m_pBuff);
     }
 
-    m_reels[x] = (SymbolType*)malloc(sizeof(SymbolType) * length);
-    m_reelsLength[x] = length;
+    m_pBuff = pBuff;
   }
 
+  // setReels - set symbol y of reel x, and its copy in the padding
   void setReels(int x, int y, SymbolType s) {
     assert(x >= 0 && x < Width);
     assert(m_reels[x] != NULL);
     assert(y >= 0 && y < m_reelsLength[x]);
 
     m_reels[x][y] = s;
+
+    if (y < Height) {
+      m_reels[x][m_reelsLength[x] + y] = s;
+    }
+
+    if (y >= m_reelsLength[x] - Height) {
+      m_reels[x][y - m_reelsLength[x]] = s;
+    }
   }
 
   int getReelsLength(int x) const {
@@ -61,11 +119,58 @@ class NormalReels {
     return m_reelsLength[x];
   }
 
+  // setStopWeights - weights of all stops of reel x, false if lstWeight is
+  //                  not valid
+  //                - 权重就是 reelsindex 是 y 的概率，不用在 csv 里重复轴
+  bool setStopWeights(int x, const std::vector<int>& lstWeight) {
+    assert(x >= 0 && x < Width);
+
+    if ((int)lstWeight.size() != m_reelsLength[x]) {
+      return false;
+    }
+
+    return buildAliasTable(lstWeight, m_lstStopWeight[x]);
+  }
+
+  bool isWeighted(int x) const {
+    assert(x >= 0 && x < Width);
+
+    return !m_lstStopWeight[x].isEmpty();
+  }
+
+  // hasStopWeights - is any reel weighted
+  bool hasStopWeights() const {
+    for (int i = 0; i < Width; ++i) {
+      if (!m_lstStopWeight[i].isEmpty()) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // randomStop - random stop of reel x, in [0, length)
+  //            - 没有权重时和 randomScale(length) 一样
+  int randomStop(int x) const {
+    assert(x >= 0 && x < Width);
+    assert(m_reelsLength[x] > 0);
+
+    if (m_lstStopWeight[x].isEmpty()) {
+      return randomScale(m_reelsLength[x]);
+    }
+
+    return randAliasTable(m_lstStopWeight[x]);
+  }
+
   SymbolType getSymbol(int x, int y) const {
     assert(x >= 0 && x < Width);
     assert(m_reels[x] != NULL);
     assert(y >= -m_reelsLength[x] && y < 2 * m_reelsLength[x]);
 
+    if (y >= -Height && y < m_reelsLength[x] + Height) {
+      return m_reels[x][y];
+    }
+
     if (y < 0) {
       y += m_reelsLength[x];
     } else if (y >= m_reelsLength[x]) {
@@ -89,6 +194,16 @@ class NormalReels {
     return m_reels[x][y];
   }
 
+  // getWindow - Height symbols of reel x from y, y is in [0, length)
+  //           - 不用判断绕回，y 是 randomScale 出来的停止位置时直接用
+  const SymbolType* getWindow(int x, int y) const {
+    assert(x >= 0 && x < Width);
+    assert(m_reels[x] != NULL);
+    assert(y >= 0 && y < m_reelsLength[x]);
+
+    return m_reels[x] + y;
+  }
+
   int countSymbol(int x, SymbolType s) const {
     assert(x >= 0 && x < Width);
     assert(m_reels[x] != NULL);
@@ -118,8 +233,84 @@ class NormalReels {
   }
 
  protected:
+  SymbolType* m_pBuff;
   SymbolType* m_reels[Width];
   int m_reelsLength[Width];
+  AliasTable m_lstStopWeight[Width];
+};
+
+// NormalReelsSet - several reels, one of them is chosen by weight per spin
+//                - 比如每个 bet 或者每个 rtp 配置一组
+template <class ReelsT>
+class NormalReelsSet {
+ public:
+  NormalReelsSet() {}
+  ~NormalReelsSet() { clear(); }
+
+  NormalReelsSet(const NormalReelsSet&) = delete;
+  NormalReelsSet& operator=(const NormalReelsSet&) = delete;
+
+ public:
+  void clear() {
+    for (auto it = m_lstReels.begin(); it != m_lstReels.end(); ++it) {
+      delete *it;
+    }
+
+    m_lstReels.clear();
+    m_lstWeight.clear();
+    m_weights = AliasTable();
+  }
+
+  bool isEmpty() const { return m_weights.isEmpty(); }
+
+  // newReels - add a reels with weight, return it to load
+  //          - 全部加完以后要调用 rebuildWeights
+  ReelsT* newReels(int weight) {
+    ReelsT* pReels = new ReelsT();
+
+    m_lstReels.push_back(pReels);
+    m_lstWeight.push_back(weight);
+
+    return pReels;
+  }
+
+  // rebuildWeights - build the weights of all reels, false if not valid
+  bool rebuildWeights() {
+    for (auto it = m_lstReels.begin(); it != m_lstReels.end(); ++it) {
+      if ((*it)->isEmpty()) {
+        m_weights = AliasTable();
+
+        return false;
+      }
+    }
+
+    return buildAliasTable(m_lstWeight, m_weights);
+  }
+
+  int getReelsNums() const { return m_lstReels.size(); }
+
+  const ReelsT& getReels(int i) const {
+    assert(i >= 0 && i < (int)m_lstReels.size());
+
+    return *m_lstReels[i];
+  }
+
+  // randomReels - index of a random reels
+  //             - 只有一组时不用随机数，和直接用那一组的结果一样
+  int randomReels() const {
+    assert(!m_weights.isEmpty());
+
+    if (m_lstReels.size() == 1) {
+      return 0;
+    }
+
+    return randAliasTable(m_weights);
+  }
+
+ protected:
+  std::vector<ReelsT*> m_lstReels;
+  std::vector<int> m_lstWeight;
+  AliasTable m_weights;
 };
 
 }  // namespace natasha
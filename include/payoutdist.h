@@ -0,0 +1,62 @@
+#ifndef __NATASHA_PAYOUTDIST_H__
+#define __NATASHA_PAYOUTDIST_H__
+
+#include <assert.h>
+#include <vector>
+#include "utils.h"
+
+namespace natasha {
+
+// PayoutDist - probability of every win, win is an integer in bet
+//   大于 maxWin 的都记在 maxWin 上，所以 maxWin 要比常见的最大赢得大很多
+//   unit - all the wins are multiples of unit, 用最大公约数可以少很多计算
+class PayoutDist {
+ public:
+  explicit PayoutDist(int maxWin = 0, int unit = 1) { init(maxWin, unit); }
+  ~PayoutDist() {}
+
+ public:
+  // init - clear and resize
+  void init(int maxWin, int unit = 1);
+
+  // add - add probability p to win
+  void add(MoneyType win, double p);
+
+  // addShift - this += p * (dist shifted by win)
+  void addShift(const PayoutDist& dist, MoneyType win, double p);
+
+  // convolve - this = a * b, the sum of 2 independent wins
+  //          - this can not be a or b
+  void convolve(const PayoutDist& a, const PayoutDist& b);
+
+  // power - this = dist ^ n, the sum of n independent wins
+  void power(const PayoutDist& dist, int n);
+
+  // prune - drop the probabilities less than minProb
+  void prune(double minProb);
+
+  int getMaxWin() const { return ((int)m_lst.size() - 1) * m_unit; }
+
+  int getUnit() const { return m_unit; }
+
+  double getProb(MoneyType win) const;
+
+  double getTotalProb() const;
+
+  // getMean - mean of win
+  double getMean() const;
+
+  // getRangeProb - probability of win in [minWin, maxWin)
+  double getRangeProb(MoneyType minWin, MoneyType maxWin) const;
+
+ protected:
+  // m_lst - m_lst[i] is the probability of win i * m_unit
+  std::vector<double> m_lst;
+  int m_unit;
+  // m_maxIndex - max index of nonzero probability, -1 if empty
+  int m_maxIndex;
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_PAYOUTDIST_H__
@@ -0,0 +1,115 @@
+#ifndef __NATASHA_PROFILE_H__
+#define __NATASHA_PROFILE_H__
+
+#include <stdint.h>
+
+// NATASHA_PROFILE - per-stage latency for gameCtrl
+//   编译时不定义 NATASHA_PROFILE，NATASHA_PROFILE_SCOPE 是空的，没有任何开销
+//   定义以后还需要 setProfileEnabled(true) 才开始统计
+
+namespace natasha {
+
+enum ProfileStage {
+  PROFILE_GAMECTRL = 0,
+  PROFILE_REVIEWGAMECTRL,
+  PROFILE_ONSPINSTART,
+  PROFILE_RANDOMREELS,
+  PROFILE_COUNTSPINRESULT,
+  PROFILE_PROCSPINRESULT,
+  PROFILE_ONSPINEND,
+  PROFILE_COUNTRTP,
+
+  PROFILE_STAGE_NUMS
+};
+
+// log-linear buckets, 16 sub buckets for each power of 2 (< 6.25% error)
+const int PROFILE_SUBBUCKET_BITS = 4;
+const int PROFILE_SUBBUCKET_NUMS = 1 << PROFILE_SUBBUCKET_BITS;
+// max value is 2^48 ns
+const int PROFILE_MAX_BITS = 48;
+const int PROFILE_BUCKET_NUMS =
+    (PROFILE_MAX_BITS - PROFILE_SUBBUCKET_BITS + 1) * PROFILE_SUBBUCKET_NUMS;
+
+// ProfileHistogram - latency histogram in nanoseconds
+struct ProfileHistogram {
+  uint64_t counts[PROFILE_BUCKET_NUMS];
+  uint64_t nums;
+  uint64_t sum;
+
+  void clear();
+
+  // getValueAtPercentile - percentile in [0, 100], return ns
+  uint64_t getValueAtPercentile(double percentile) const;
+
+  uint64_t getMean() const { return nums > 0 ? sum / nums : 0; }
+};
+
+// ProfileSnapshot - all stages, merged from all threads
+struct ProfileSnapshot {
+  ProfileHistogram stages[PROFILE_STAGE_NUMS];
+};
+
+// getProfileBucket - value(ns) -> bucket index
+int getProfileBucket(uint64_t ns);
+
+// getProfileBucketValue - bucket index -> lowest value(ns) of the bucket
+uint64_t getProfileBucketValue(int bucket);
+
+// getProfileStageName - stage name for export
+const char* getProfileStageName(int stage);
+
+#ifdef NATASHA_PROFILE
+
+// setProfileEnabled - runtime switch, default is disabled
+void setProfileEnabled(bool enabled);
+
+// isProfileEnabled - runtime switch
+bool isProfileEnabled();
+
+// addProfile - record a latency for current thread
+void addProfile(ProfileStage stage, uint64_t ns);
+
+// getProfileNanoseconds - monotonic clock in ns
+uint64_t getProfileNanoseconds();
+
+// getProfileSnapshot - merge all threads
+void getProfileSnapshot(ProfileSnapshot& snapshot);
+
+// resetProfile - the next snapshot only counts the samples after reset
+void resetProfile();
+
+// outputProfile - print snapshot
+void outputProfile();
+
+// ProfileScope - record the lifetime of the scope
+class ProfileScope {
+ public:
+  explicit ProfileScope(ProfileStage stage)
+      : m_stage(stage),
+        m_start(isProfileEnabled() ? getProfileNanoseconds() : 0) {}
+  ~ProfileScope() {
+    if (m_start > 0) {
+      addProfile(m_stage, getProfileNanoseconds() - m_start);
+    }
+  }
+
+ private:
+  ProfileStage m_stage;
+  uint64_t m_start;
+};
+
+#define NATASHA_PROFILE_CONCAT_(a, b) a##b
+#define NATASHA_PROFILE_CONCAT(a, b) NATASHA_PROFILE_CONCAT_(a, b)
+#define NATASHA_PROFILE_SCOPE(stage)                                     \
+  ::natasha::ProfileScope NATASHA_PROFILE_CONCAT(__natasha_profile_scope_, \
+                                                 __LINE__)(stage)
+
+#else  // NATASHA_PROFILE
+
+#define NATASHA_PROFILE_SCOPE(stage)
+
+#endif  // NATASHA_PROFILE
+
+}  // namespace natasha
+
+#endif  // __NATASHA_PROFILE_H__
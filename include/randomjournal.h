@@ -0,0 +1,62 @@
+#ifndef __NATASHA_RANDOMJOURNAL_H__
+#define __NATASHA_RANDOMJOURNAL_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <string>
+
+namespace natasha {
+
+// RANDOMJOURNAL_FULLRANGE - range of the draws of random and randomArray
+const uint32_t RANDOMJOURNAL_FULLRANGE = 0;
+
+// RandomJournal - all draws of a thread, range and value of each draw as
+//                 two LEB128 varints
+//               - range 是 randomScale 的 max，random 的是
+//                 RANDOMJOURNAL_FULLRANGE，被拒绝重取的不记录
+//               - 转轴停止位置这种小数字一次只要 2 到 4 个字节
+class RandomJournal {
+ public:
+  RandomJournal() : m_nums(0) {}
+  ~RandomJournal() {}
+
+ public:
+  // push - add a draw
+  void push(uint32_t range, uint32_t value) {
+    assert(range == RANDOMJOURNAL_FULLRANGE || value < range);
+
+    pushVarint(range);
+    pushVarint(value);
+
+    ++m_nums;
+  }
+
+  void clear() {
+    m_data.clear();
+    m_nums = 0;
+  }
+
+  // getData - the varint stream, saved with the round record
+  const std::string& getData() const { return m_data; }
+
+  // getNums - nums of draws
+  int getNums() const { return m_nums; }
+
+ protected:
+  void pushVarint(uint32_t v) {
+    while (v >= 0x80) {
+      m_data.push_back((char)(v | 0x80));
+      v >>= 7;
+    }
+
+    m_data.push_back((char)v);
+  }
+
+ protected:
+  std::string m_data;
+  int m_nums;
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_RANDOMJOURNAL_H__
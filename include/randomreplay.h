@@ -0,0 +1,120 @@
+#ifndef __NATASHA_RANDOMREPLAY_H__
+#define __NATASHA_RANDOMREPLAY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "randomjournal.h"
+
+// randomreplay.h - replay of a RandomJournal, only for NATASHA_SIMULATION
+//   - 审计工具用的，正式服务器只记录 journal，不能回放
+
+namespace natasha {
+
+// RandomReplayState - state of RandomReplay
+enum RandomReplayState {
+  RANDOMREPLAY_OK = 0,
+  // 需要的比记录的多
+  RANDOMREPLAY_OVERRUN = 1,
+  // range 和记录的不一样，或者 value 不在 range 里
+  RANDOMREPLAY_MISMATCH = 2,
+  // varint 不完整
+  RANDOMREPLAY_INVALID_DATA = 3,
+};
+
+// RandomReplay - the draws of a RandomJournal, in the same order
+//              - 出错以后 pop 都返回 false，value 是 0，
+//                游戏逻辑还能跑完，由调用者检查 getState
+//              - 不复制数据，data 在回放结束前不能释放
+class RandomReplay {
+ public:
+  RandomReplay() { init(NULL, 0); }
+  explicit RandomReplay(const std::string& data) {
+    init(data.data(), data.size());
+  }
+  ~RandomReplay() {}
+
+ public:
+  void init(const char* pData, size_t len) {
+    m_pCur = (const uint8_t*)pData;
+    m_pEnd = m_pCur + len;
+    m_nums = 0;
+    m_state = RANDOMREPLAY_OK;
+  }
+
+  // pop - the next draw, range must be the same as the journal
+  bool pop(uint32_t range, uint32_t& value) {
+    value = 0;
+
+    if (m_state != RANDOMREPLAY_OK) {
+      return false;
+    }
+
+    if (m_pCur >= m_pEnd) {
+      m_state = RANDOMREPLAY_OVERRUN;
+
+      return false;
+    }
+
+    uint32_t r = 0;
+    uint32_t v = 0;
+    if (!popVarint(r) || !popVarint(v)) {
+      m_state = RANDOMREPLAY_INVALID_DATA;
+
+      return false;
+    }
+
+    if (r != range || (r != RANDOMJOURNAL_FULLRANGE && v >= r)) {
+      m_state = RANDOMREPLAY_MISMATCH;
+
+      return false;
+    }
+
+    value = v;
+    ++m_nums;
+
+    return true;
+  }
+
+  // isEnd - all draws are used
+  bool isEnd() const { return m_pCur >= m_pEnd; }
+
+  // isFinished - no error and all draws are used
+  //            - 回放验证通过的条件
+  bool isFinished() const { return m_state == RANDOMREPLAY_OK && isEnd(); }
+
+  RandomReplayState getState() const { return m_state; }
+
+  // getNums - nums of draws used
+  int getNums() const { return m_nums; }
+
+ protected:
+  bool popVarint(uint32_t& v) {
+    v = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+      if (m_pCur >= m_pEnd) {
+        return false;
+      }
+
+      uint8_t b = *m_pCur++;
+      v |= (uint32_t)(b & 0x7f) << shift;
+
+      if ((b & 0x80) == 0) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+ protected:
+  const uint8_t* m_pCur;
+  const uint8_t* m_pEnd;
+  int m_nums;
+  RandomReplayState m_state;
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_RANDOMREPLAY_H__
@@ -0,0 +1,80 @@
+#ifndef __NATASHA_RANDOMSHARDS_H__
+#define __NATASHA_RANDOMSHARDS_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "fortuna.h"
+
+namespace natasha {
+
+#ifdef NATASHA_SIMULATION
+// 只给多线程模拟用，只在定义了 NATASHA_SIMULATION 时才有
+
+// getShardSize - size of shard in total, the first total % shardNums shards
+//                have one more
+inline int64_t getShardSize(int64_t total, int shardNums, int shard) {
+  assert(shardNums > 0 && shard >= 0 && shard < shardNums);
+
+  return total / shardNums + (shard < total % shardNums ? 1 : 0);
+}
+
+// runRandomShards - run func(shard, thread) for all shards in threadNums
+//                   threads, shard i uses random stream i of seed
+//   FuncT - void func(int shard, int thread)
+//   - shard 在哪个线程里跑都用一样的随机数，结果只和 seed、shardNums 有关，
+//     线程数只影响速度
+//   - func 的结果要按 shard 保存，全部结束后按 shard 顺序合并
+//   - thread 在 [0, threadNums)，同一时间只有一个 shard 用同一个 thread
+template <typename FuncT>
+void runRandomShards(uint64_t seed, int shardNums, int threadNums,
+                     FuncT func) {
+  assert(shardNums > 0);
+  assert(threadNums > 0);
+
+  // stream i 是 stream i - 1 再 jump 一次
+  std::vector<Xoshiro256> lstState(shardNums);
+  lstState[0].seed(seed);
+  for (int i = 1; i < shardNums; ++i) {
+    lstState[i] = lstState[i - 1];
+    lstState[i].jump();
+  }
+
+  std::atomic<int> nextShard(0);
+
+  auto proc = [&](int thread) {
+    for (int shard = nextShard++; shard < shardNums; shard = nextShard++) {
+      setThreadRandomState(lstState[shard]);
+
+      func(shard, thread);
+    }
+
+    clearThreadRandomSeed();
+  };
+
+  if (threadNums > shardNums) {
+    threadNums = shardNums;
+  }
+
+  if (threadNums == 1) {
+    proc(0);
+
+    return;
+  }
+
+  std::vector<std::thread> lstThread;
+  for (int i = 0; i < threadNums; ++i) {
+    lstThread.push_back(std::thread(proc, i));
+  }
+
+  for (auto& t : lstThread) {
+    t.join();
+  }
+}
+#endif  // NATASHA_SIMULATION
+
+}  // namespace natasha
+
+#endif  // __NATASHA_RANDOMSHARDS_H__
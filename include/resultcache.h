@@ -0,0 +1,223 @@
+#ifndef __NATASHA_RESULTCACHE_H__
+#define __NATASHA_RESULTCACHE_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "../protoc/base.pb.h"
+#include "symbolblock2.h"
+#include "utils.h"
+
+namespace natasha {
+
+// BoardResultCache - LRU cache of bet-independent results, key is board hash
+//                  - 结果里只有 mul，win 是 bet 为 1 的值，命中时会比较整个盘面
+//                  - find 会改 LRU，不是线程安全的，
+//                    用 getThreadBoardResultCache 每个线程一个
+template <class SymbolBlockT, int Width, int Height>
+class BoardResultCache {
+ public:
+  typedef std::array<SymbolType, Width * Height> BoardT;
+
+  struct Node {
+    uint64_t hash;
+    BoardT board;
+    ::natashapb::SpinResult unit;
+  };
+
+  typedef std::list<Node> NodeList;
+  typedef std::unordered_map<uint64_t, typename NodeList::iterator> MapNode;
+
+ public:
+  explicit BoardResultCache(int maxNums)
+      : m_maxNums(maxNums), m_hitNums(0), m_missNums(0) {}
+  ~BoardResultCache() {}
+
+ public:
+  // buildBoard - copy arr to board, and return the hash of board
+  static uint64_t buildBoard(const SymbolBlockT& arr, BoardT& board) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (int y = 0; y < Height; ++y) {
+      for (int x = 0; x < Width; ++x) {
+        auto s = getSymbolBlock<SymbolBlockT, Width, Height>(&arr, x, y);
+        board[y * Width + x] = s;
+
+        hash ^= (uint64_t)(uint32_t)s;
+        hash *= 1099511628211ULL;
+      }
+    }
+
+    return hash;
+  }
+
+  // find - find the unit result of board, NULL if not found
+  const ::natashapb::SpinResult* find(const BoardT& board, uint64_t hash) {
+    auto it = m_map.find(hash);
+    if (it == m_map.end() || it->second->board != board) {
+      ++m_missNums;
+
+      return NULL;
+    }
+
+    m_lst.splice(m_lst.begin(), m_lst, it->second);
+    ++m_hitNums;
+
+    return &it->second->unit;
+  }
+
+  // insert - insert the unit result of board, unit will be swapped
+  //        - hash 冲突时替换旧的
+  const ::natashapb::SpinResult* insert(const BoardT& board, uint64_t hash,
+                                        ::natashapb::SpinResult& unit) {
+    assert(m_maxNums > 0);
+
+    auto it = m_map.find(hash);
+    if (it != m_map.end()) {
+      m_lst.erase(it->second);
+      m_map.erase(it);
+    } else if ((int)m_lst.size() >= m_maxNums) {
+      m_map.erase(m_lst.back().hash);
+      m_lst.pop_back();
+    }
+
+    m_lst.emplace_front();
+
+    auto& node = m_lst.front();
+    node.hash = hash;
+    node.board = board;
+    node.unit.Swap(&unit);
+
+    m_map[hash] = m_lst.begin();
+
+    return &node.unit;
+  }
+
+  void clear() {
+    m_lst.clear();
+    m_map.clear();
+    m_hitNums = 0;
+    m_missNums = 0;
+  }
+
+  int getMaxNums() const { return m_maxNums; }
+
+  int getNums() const { return m_lst.size(); }
+
+  int64_t getHitNums() const { return m_hitNums; }
+
+  int64_t getMissNums() const { return m_missNums; }
+
+ protected:
+  int m_maxNums;
+  NodeList m_lst;
+  MapNode m_map;
+  int64_t m_hitNums;
+  int64_t m_missNums;
+};
+
+typedef BoardResultCache< ::natashapb::SymbolBlock3X5, 5, 3>
+    BoardResultCache3X5;
+
+// newBoardResultCacheID - a new cache id, unique in the process
+//                       - 一个 GameLogic 的一种结果用一个 id
+inline uint64_t newBoardResultCacheID() {
+  static std::atomic<uint64_t> s_id(0);
+
+  return ++s_id;
+}
+
+// BoardResultCacheMap - caches of current thread, id -> cache
+template <class CacheT>
+using BoardResultCacheMap =
+    std::unordered_map<uint64_t, std::unique_ptr<CacheT> >;
+
+// getThreadBoardResultCacheMap - all caches of CacheT in current thread
+//                              - 线程结束时释放
+template <class CacheT>
+BoardResultCacheMap<CacheT>& getThreadBoardResultCacheMap() {
+  thread_local BoardResultCacheMap<CacheT> s_map;
+
+  return s_map;
+}
+
+// getThreadBoardResultCache - the cache of id in current thread, NULL if
+//                             maxNums <= 0
+//                           - 共享的 GameLogic 在多个线程里也不会共用一个 LRU
+template <class CacheT>
+CacheT* getThreadBoardResultCache(uint64_t id, int maxNums) {
+  if (maxNums <= 0) {
+    return NULL;
+  }
+
+  auto& p = getThreadBoardResultCacheMap<CacheT>()[id];
+  if (!p) {
+    p.reset(new CacheT(maxNums));
+  }
+
+  return p.get();
+}
+
+// releaseThreadBoardResultCache - release the cache of id in current thread
+//                               - 其他线程里的要到线程结束才释放
+template <class CacheT>
+void releaseThreadBoardResultCache(uint64_t id) {
+  getThreadBoardResultCacheMap<CacheT>().erase(id);
+}
+
+// ThreadBoardResultCache - id and size of a per-thread BoardResultCache
+//                        - maxNums 为 0 时关闭
+template <class CacheT>
+struct ThreadBoardResultCache {
+  uint64_t id;
+  int maxNums;
+
+  ThreadBoardResultCache() : id(0), maxNums(0) {}
+
+  // get - the cache of current thread, NULL if disabled
+  CacheT* get() const { return getThreadBoardResultCache<CacheT>(id, maxNums); }
+};
+
+typedef ThreadBoardResultCache<BoardResultCache3X5> ThreadBoardResultCache3X5;
+
+// countWithResultCache - append the result of arr to sr with bet, returns the
+//                        total win
+//                      - funcUnit(unit) 只在没命中时调用，只算 mul
+//                      - 不修改 sr.win，由调用者处理
+//                      - 命中时还是要把 gri 复制到 sr，客户端和 rtp 统计都要用，
+//                        省下的只是计算，没有中奖的盘面什么都不复制
+template <class SymbolBlockT, int Width, int Height, typename FuncUnitT>
+MoneyType countWithResultCache(
+    BoardResultCache<SymbolBlockT, Width, Height>& cache,
+    ::natashapb::SpinResult& sr, const SymbolBlockT& arr, MoneyType bet,
+    FuncUnitT funcUnit) {
+  typedef BoardResultCache<SymbolBlockT, Width, Height> CacheT;
+
+  typename CacheT::BoardT board;
+  auto hash = CacheT::buildBoard(arr, board);
+
+  auto pUnit = cache.find(board, hash);
+  if (pUnit == NULL) {
+    ::natashapb::SpinResult unit;
+    funcUnit(unit);
+
+    pUnit = cache.insert(board, hash, unit);
+  }
+
+  int begin = sr.lstgri_size();
+
+  for (int i = 0; i < pUnit->lstgri_size(); ++i) {
+    sr.add_lstgri()->CopyFrom(pUnit->lstgri(i));
+  }
+
+  return applyBetToGameResult(sr, begin, bet);
+}
+
+}  // namespace natasha
+
+#endif  // __NATASHA_RESULTCACHE_H__
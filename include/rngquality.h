@@ -0,0 +1,53 @@
+#ifndef __NATASHA_RNGQUALITY_H__
+#define __NATASHA_RNGQUALITY_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+#include "../protoc/base.pb.h"
+
+namespace natasha {
+
+// ChiSquareResult - Pearson chi-square goodness of fit
+//   pValue - probability of a chi2 at least this big if the draws follow the
+//            expected distribution
+//   很小的 pValue（比如 < 0.01）说明分布不对，很大也不说明什么
+struct ChiSquareResult {
+  int64_t drawNums;
+  int bins;
+  double chi2;
+  int dof;
+  double pValue;
+
+  ChiSquareResult() : drawNums(0), bins(0), chi2(0), dof(0), pValue(0) {}
+};
+
+// chiSquarePValue - upper tail of chi-square with dof degrees of freedom
+double chiSquarePValue(double chi2, int dof);
+
+// countChiSquare - chi-square of lstCount against lstProb, false if the sizes
+//                  are different, or less than 2 bins
+//                - lstProb 的和必须是 1，概率是 0 的格子不算
+bool countChiSquare(const std::vector<int64_t>& lstCount,
+                    const std::vector<double>& lstProb,
+                    ChiSquareResult& result);
+
+// testRandomScale - chi-square of drawNums randomScale(max)
+//                 - max 大于 maxBins 时按 v * maxBins / max 合并成 maxBins 格，
+//                   每格的概率按整数个数精确计算
+bool testRandomScale(uint32_t max, int64_t drawNums, int maxBins,
+                     ChiSquareResult& result);
+
+// testRandWeightConfig - chi-square of drawNums randWeightConfig against the
+//                        weights of cfg
+bool testRandWeightConfig(const ::natashapb::WeightConfig& cfg,
+                          int64_t drawNums, ChiSquareResult& result);
+
+// testRandAliasTable - chi-square of drawNums randAliasTable against the
+//                      weights of cfg
+bool testRandAliasTable(const ::natashapb::WeightConfig& cfg,
+                        int64_t drawNums, ChiSquareResult& result);
+
+}  // namespace natasha
+
+#endif  // __NATASHA_RNGQUALITY_H__
@@ -11,12 +11,45 @@
 
 namespace natasha {
 
+// RTP_MAX_MODULE - max GAMEMODTYPE + 1
+const int RTP_MAX_MODULE = 8;
+// RTP_MAX_BONUS - max bonus nums in a module
+const int RTP_MAX_BONUS = 8;
+
 struct RTP {
   ::natashapb::RTP rtp;
 
   RTP() { clear(); }
 
-  void clear() { rtp.Clear(); }
+  RTP(const RTP& other) {
+    rtp.CopyFrom(other.rtp);
+
+    clearCache();
+  }
+
+  RTP& operator=(const RTP& other) {
+    if (this != &other) {
+      rtp.CopyFrom(other.rtp);
+
+      clearCache();
+    }
+
+    return *this;
+  }
+
+  void clear() {
+    rtp.Clear();
+
+    clearCache();
+  }
+
+  // clearCache - the cached pointers are invalid after rtp changed
+  void clearCache() {
+    for (int i = 0; i < RTP_MAX_MODULE; ++i) {
+      lstModule[i] = NULL;
+      lstBonusNums[i] = 0;
+    }
+  }
 
   void addPayout2Module(::natashapb::GameModuleRTP& gm, SymbolType s, int nums,
                         MoneyType payout) {
@@ -48,77 +81,66 @@ struct RTP {
 
       delete gm;
     }
+
+    // init 时才会加 module，直接重建缓存
+    clearCache();
+    lstModule[module] = &((*gamemodules)[gmname]);
   }
 
   void initModuleBonus(::natashapb::GAMEMODTYPE module, const char* bonusName,
                        int maxNums) {
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
+    auto gm = getModule(module);
+    if (gm != NULL) {
       auto bonus = _newBonus(maxNums);
 
       ::google::protobuf::MapPair< ::std::string, ::natashapb::BonusRTPList> p(
           bonusName, *bonus);
 
-      gmit->second.mutable_bonus()->insert(p);
+      gm->mutable_bonus()->insert(p);
+      lstBonusNums[module] = 0;
+
+      delete bonus;
     }
   }
 
   void addBonusPayout(::natashapb::GAMEMODTYPE module, const char* bonusName,
                       int bonusIndex, MoneyType payout) {
     // printf("addBonusPayout %s %d\n", bonusName, bonusIndex);
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
-      auto bonusit = gmit->second.mutable_bonus()->find(bonusName);
-      // printf("addBonusPayout %s\n", bonusName);
-      if (bonusit != gmit->second.mutable_bonus()->end()) {
-        // printf("addBonusPayout %s OK\n", bonusName);
-        // printf("addBonusPayout %d OK\n", bonusIndex);
-        assert(bonusIndex >= 0 && bonusIndex < bonusit->second.lst_size());
-
-        auto currtp = bonusit->second.mutable_lst(bonusIndex);
+    auto bonus = getBonus(module, bonusName);
+    if (bonus != NULL) {
+      // printf("addBonusPayout %s OK\n", bonusName);
+      // printf("addBonusPayout %d OK\n", bonusIndex);
+      assert(bonusIndex >= 0 && bonusIndex < bonus->lst_size());
 
-        currtp->set_winnums(currtp->winnums() + 1);
-        currtp->set_totalwin(currtp->totalwin() + payout);
-        currtp->set_realwin(currtp->realwin() + payout);
+      auto currtp = bonus->mutable_lst(bonusIndex);
 
-        // printf("addBonusPayout %lld\n", currtp->totalwin());
-      }
+      currtp->set_winnums(currtp->winnums() + 1);
+      currtp->set_totalwin(currtp->totalwin() + payout);
+      currtp->set_realwin(currtp->realwin() + payout);
 
-      // gmit->second.set_totalwin(gmit->second.totalwin() + payout);
-      // gmit->second.set_winnums(gmit->second.winnums() + 1);
+      // printf("addBonusPayout %lld\n", currtp->totalwin());
     }
   }
 
   void addPayout(::natashapb::GAMEMODTYPE module, MoneyType payout) {
     rtp.set_totalwin(rtp.totalwin() + payout);
 
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
-      gmit->second.set_totalwin(gmit->second.totalwin() + payout);
+    auto gm = getModule(module);
+    if (gm != NULL) {
+      gm->set_totalwin(gm->totalwin() + payout);
       if (payout > 0) {
-        gmit->second.set_winnums(gmit->second.winnums() + 1);
+        gm->set_winnums(gm->winnums() + 1);
       }
     }
   }
 
   void addSymbolPayout(::natashapb::GAMEMODTYPE module, SymbolType s, int nums,
                        MoneyType payout) {
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
+    auto gm = getModule(module);
+    if (gm != NULL) {
       // printf("addSymbolPayout %d %d\n", s, nums);
 
-      addPayout2Module(gmit->second, s, nums, payout);
-
-      // gmit->second.set_totalwin(gmit->second.totalwin() + payout);
-      // gmit->second.set_winnums(gmit->second.winnums() + 1);
+      addPayout2Module(*gm, s, nums, payout);
     }
   }
 
@@ -127,33 +149,72 @@ struct RTP {
       rtp.set_totalbet(rtp.totalbet() + bet);
       rtp.set_spinnums(rtp.spinnums() + 1);
 
-      auto gmname = getGameModuleName(module);
-      auto gamemodules = rtp.mutable_gamemodules();
-      auto gmit = gamemodules->find(gmname);
-      if (gmit != gamemodules->end()) {
-        gmit->second.set_spinnums(gmit->second.spinnums() + 1);
+      auto gm = getModule(module);
+      if (gm != NULL) {
+        gm->set_spinnums(gm->spinnums() + 1);
       }
     }
   }
 
   void addSpecialSpinNums(::natashapb::GAMEMODTYPE module) {
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
-      gmit->second.set_spinnums(gmit->second.spinnums() + 1);
+    auto gm = getModule(module);
+    if (gm != NULL) {
+      gm->set_spinnums(gm->spinnums() + 1);
     }
   }
 
   void addInGameModule(::natashapb::GAMEMODTYPE module) {
-    auto gmname = getGameModuleName(module);
-    auto gamemodules = rtp.mutable_gamemodules();
-    auto gmit = gamemodules->find(gmname);
-    if (gmit != gamemodules->end()) {
-      gmit->second.set_innums(gmit->second.innums() + 1);
+    auto gm = getModule(module);
+    if (gm != NULL) {
+      gm->set_innums(gm->innums() + 1);
     }
   }
 
+  // getModule - module rtp, NULL if not added
+  //           - 用 GAMEMODTYPE 做下标缓存指针，每次统计不用再按名字查 map
+  ::natashapb::GameModuleRTP* getModule(::natashapb::GAMEMODTYPE module) {
+    assert(module >= 0 && module < RTP_MAX_MODULE);
+
+    if (lstModule[module] == NULL) {
+      auto gamemodules = rtp.mutable_gamemodules();
+      auto gmit = gamemodules->find(getGameModuleName(module));
+      if (gmit != gamemodules->end()) {
+        lstModule[module] = &gmit->second;
+      }
+    }
+
+    return lstModule[module];
+  }
+
+  // getBonus - bonus rtp of module, NULL if not added
+  //          - bonusName 一般是字符串常量，先比较指针
+  ::natashapb::BonusRTPList* getBonus(::natashapb::GAMEMODTYPE module,
+                                      const char* bonusName) {
+    auto gm = getModule(module);
+    if (gm == NULL) {
+      return NULL;
+    }
+
+    for (int i = 0; i < lstBonusNums[module]; ++i) {
+      if (lstBonusName[module][i] == bonusName) {
+        return lstBonus[module][i];
+      }
+    }
+
+    auto bonusit = gm->mutable_bonus()->find(bonusName);
+    if (bonusit == gm->mutable_bonus()->end()) {
+      return NULL;
+    }
+
+    if (lstBonusNums[module] < RTP_MAX_BONUS) {
+      lstBonusName[module][lstBonusNums[module]] = bonusName;
+      lstBonus[module][lstBonusNums[module]] = &bonusit->second;
+      lstBonusNums[module]++;
+    }
+
+    return &bonusit->second;
+  }
+
   void output() {
     printf("RTP is %.4f(%lld / %lld)\n",
            100.f * rtp.totalwin() / rtp.totalbet(), rtp.totalwin(),
@@ -163,6 +224,14 @@ struct RTP {
     outputGameModule(::natashapb::FREE_GAME);
   }
 
+ protected:
+  // lstModule - cached pointers of rtp.gamemodules, index is GAMEMODTYPE
+  ::natashapb::GameModuleRTP* lstModule[RTP_MAX_MODULE];
+  // lstBonus - cached pointers of bonus, with the bonusName pointers
+  ::natashapb::BonusRTPList* lstBonus[RTP_MAX_MODULE][RTP_MAX_BONUS];
+  const char* lstBonusName[RTP_MAX_MODULE][RTP_MAX_BONUS];
+  int lstBonusNums[RTP_MAX_MODULE];
+
  protected:
   ::natashapb::GameModuleRTP* _newModule(int maxNums, int maxSymbol) {
     auto gm = new ::natashapb::GameModuleRTP();
@@ -197,12 +266,12 @@ struct RTP {
              gmit->second.totalwin(), rtp.totalbet());
 
       for (int s = 0; s < gmit->second.symbols_size(); ++s) {
-        auto cs = gmit->second.symbols(s);
+        const auto& cs = gmit->second.symbols(s);
 
         printf("%d RTP is ", s);
 
         for (int i = 0; i < cs.lst_size(); ++i) {
-          auto curs = cs.lst(i);
+          const auto& curs = cs.lst(i);
 
           printf("%.4f ", 100.f * curs.totalwin() / rtp.totalbet());
         }
@@ -210,12 +279,12 @@ struct RTP {
         printf("\n");
       }
 
-      auto mapbonus = gmit->second.bonus();
+      const auto& mapbonus = gmit->second.bonus();
       for (auto it = mapbonus.begin(); it != mapbonus.end(); ++it) {
-        auto curbonus = it->second;
+        const auto& curbonus = it->second;
         printf("%s RTP is ", it->first.c_str());
         for (int i = 0; i < curbonus.lst_size(); ++i) {
-          auto curs = curbonus.lst(i);
+          const auto& curs = curbonus.lst(i);
 
           printf("%.4f ", 100.f * curs.totalwin() / rtp.totalbet());
         }
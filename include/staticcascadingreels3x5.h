@@ -21,6 +21,9 @@ class StaticCascadingReels3X5 {
   void random(::natashapb::RandomResult* pRandomResult,
               const ::natashapb::UserGameModInfo* pUGMI);
 
+  // randomWithIndex - set the index-th scenario, like random with isend
+  void randomWithIndex(::natashapb::RandomResult* pRandomResult, int index);
+
   void clear();
 
   bool isEmpty() const { return m_lst.empty(); }
@@ -49,9 +52,19 @@ class StaticCascadingReels3X5 {
     return m_lst[y]->at(x);
   }
 
+  const ::natashapb::SymbolBlock3X5* getNode(int x, int y) const {
+    assert(y >= 0 && y < m_lst.size());
+    assert(x >= 0 && x < m_maxDownNums);
+
+    return m_lst[y]->at(x);
+  }
+
  protected:
   void randomNew(::natashapb::StaticCascadingRandomResult3X5* pSCRR);
 
+  void newWithIndex(::natashapb::StaticCascadingRandomResult3X5* pSCRR,
+                    int index);
+
   void fill(::natashapb::StaticCascadingRandomResult3X5* pSCRR,
             const ::natashapb::SymbolBlock3X5* pLastSB);
 
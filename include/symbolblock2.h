@@ -59,6 +59,89 @@ inline void setSymbolBlock< ::natashapb::SymbolBlock3X5, 5, 3>(
   setSymbolBlock3X5(pSB, x, y, s);
 };
 
+// CascadePermTable - 2^Height entries, for the holes of a column (bit y is y),
+//                    the source row of every row after cascading, -1 is a hole
+//                  - lstMove 为 false 时这一列不用动
+template <int Height>
+struct CascadePermTable {
+  static_assert(Height > 0 && Height <= 8, "2^Height entries");
+
+  static const int Nums = 1 << Height;
+
+  int8_t lstSrc[Nums][Height];
+  bool lstMove[Nums];
+
+  constexpr CascadePermTable() : lstSrc(), lstMove() {
+    for (int mask = 0; mask < Nums; ++mask) {
+      int dst = Height - 1;
+      bool move = false;
+
+      for (int y = Height - 1; y >= 0; --y) {
+        if ((mask & (1 << y)) == 0) {
+          lstSrc[mask][dst] = y;
+          move = move || dst != y;
+          --dst;
+        }
+      }
+
+      for (; dst >= 0; --dst) {
+        lstSrc[mask][dst] = -1;
+      }
+
+      lstMove[mask] = move;
+    }
+  }
+};
+
+// cascadeColumn - cascade a column, column[y] < 0 is a hole
+//               - returns false if nothing moved
+template <typename SymbolType, int Height>
+bool cascadeColumn(SymbolType (&column)[Height]) {
+  static constexpr CascadePermTable<Height> s_table =
+      CascadePermTable<Height>();
+
+  int mask = 0;
+  for (int y = 0; y < Height; ++y) {
+    mask |= (column[y] < 0) << y;
+  }
+
+  if (!s_table.lstMove[mask]) {
+    return false;
+  }
+
+  SymbolType src[Height];
+  for (int y = 0; y < Height; ++y) {
+    src[y] = column[y];
+  }
+
+  for (int y = 0; y < Height; ++y) {
+    int sy = s_table.lstSrc[mask][y];
+    column[y] = sy >= 0 ? src[sy] : -1;
+  }
+
+  return true;
+}
+
+// cascadeBlock - cascade SymbolBlock, any Height
+//              - 每列读一次，只写回动过的列
+template <typename SymbolBlockT, int Width, int Height>
+void cascadeBlock(SymbolBlockT* pSB) {
+  assert(pSB != NULL);
+
+  for (int x = 0; x < Width; ++x) {
+    SymbolType column[Height];
+    for (int y = 0; y < Height; ++y) {
+      column[y] = getSymbolBlock<SymbolBlockT, Width, Height>(pSB, x, y);
+    }
+
+    if (cascadeColumn<SymbolType, Height>(column)) {
+      for (int y = 0; y < Height; ++y) {
+        setSymbolBlock<SymbolBlockT, Width, Height>(pSB, x, y, column[y]);
+      }
+    }
+  }
+}
+
 }  // namespace natasha
 
 #endif  // __NATASHA_SYMBOLBLOCK2_H__
\ No newline at end of file
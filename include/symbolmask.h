@@ -0,0 +1,202 @@
+#ifndef __NATASHA_SYMBOLMASK_H__
+#define __NATASHA_SYMBOLMASK_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include "symbolblock2.h"
+#include "utils.h"
+
+namespace natasha {
+
+typedef uint32_t BoardMask;
+
+// countBoardMask - number of positions in mask
+inline int countBoardMask(BoardMask mask) { return __builtin_popcount(mask); }
+
+// popBoardMask - remove the lowest position of mask and return its index
+//              - index 从小到大就是 y 优先的扫描顺序
+inline int popBoardMask(BoardMask& mask) {
+  assert(mask != 0);
+
+  int i = __builtin_ctz(mask);
+  mask &= mask - 1;
+
+  return i;
+}
+
+// BoardNeighborTable - 3x3 neighbourhood of every position, with itself
+template <int Width, int Height>
+struct BoardNeighborTable {
+  BoardMask lstMask[Width * Height];
+
+  constexpr BoardNeighborTable() : lstMask() {
+    for (int y = 0; y < Height; ++y) {
+      for (int x = 0; x < Width; ++x) {
+        BoardMask mask = 0;
+
+        for (int cy = y - 1; cy <= y + 1; ++cy) {
+          for (int cx = x - 1; cx <= x + 1; ++cx) {
+            if (cy >= 0 && cy < Height && cx >= 0 && cx < Width) {
+              mask |= ((BoardMask)1) << (cy * Width + cx);
+            }
+          }
+        }
+
+        lstMask[y * Width + x] = mask;
+      }
+    }
+  }
+};
+
+// SymbolMask - masks of all symbols on a board, bit y * Width + x
+//            - 盘面出来以后 build 一次，scatter、wild 都不用再扫盘面
+//            - 不在 [0, MaxSymbols) 里的（-1 的空格）都在 getOtherMask 里
+template <class SymbolBlockT, int Width, int Height, int MaxSymbols>
+class SymbolMask {
+ public:
+  static const int Size = Width * Height;
+  static const int SymbolNums = MaxSymbols;
+
+  static_assert(Size <= 32, "BoardMask is uint32_t");
+
+ public:
+  SymbolMask() { clear(); }
+
+ public:
+  // build - build masks of arr
+  void build(const SymbolBlockT& arr) {
+    clear();
+
+    for (int y = 0; y < Height; ++y) {
+      for (int x = 0; x < Width; ++x) {
+        auto s = getSymbolBlock<SymbolBlockT, Width, Height>(&arr, x, y);
+        int i = getIndex(x, y);
+
+        m_lstSymbol[i] = s;
+
+        if (s >= 0 && s < MaxSymbols) {
+          m_lstMask[s] |= getPosMask(i);
+        } else {
+          m_otherMask |= getPosMask(i);
+        }
+      }
+    }
+  }
+
+  void clear() {
+    for (int i = 0; i < MaxSymbols; ++i) {
+      m_lstMask[i] = 0;
+    }
+
+    m_otherMask = 0;
+  }
+
+  // getMask - positions of s
+  BoardMask getMask(SymbolType s) const {
+    if (s >= 0 && s < MaxSymbols) {
+      return m_lstMask[s];
+    }
+
+    return 0;
+  }
+
+  // getOtherMask - positions of the symbols not in [0, MaxSymbols)
+  BoardMask getOtherMask() const { return m_otherMask; }
+
+  // countSymbol - number of s
+  int countSymbol(SymbolType s) const { return countBoardMask(getMask(s)); }
+
+  // getChangedMask - positions whose symbol is not the same as in other
+  BoardMask getChangedMask(const SymbolMask& other) const {
+    BoardMask mask = 0;
+    for (int i = 0; i < Size; ++i) {
+      if (m_lstSymbol[i] != other.m_lstSymbol[i]) {
+        mask |= getPosMask(i);
+      }
+    }
+
+    return mask;
+  }
+
+  // getSymbol - symbol of index i
+  SymbolType getSymbol(int i) const {
+    assert(i >= 0 && i < Size);
+
+    return m_lstSymbol[i];
+  }
+
+  static int getIndex(int x, int y) { return y * Width + x; }
+
+  static int getX(int i) { return i % Width; }
+
+  static int getY(int i) { return i / Width; }
+
+  static BoardMask getPosMask(int i) { return ((BoardMask)1) << i; }
+
+  // getNeighborMask - 3x3 neighbourhood of index i, with i
+  static BoardMask getNeighborMask(int i) {
+    assert(i >= 0 && i < Size);
+
+    return s_neighbors.lstMask[i];
+  }
+
+  // buildResultMask - positions of all results in sr
+  static BoardMask buildResultMask(const ::natashapb::SpinResult& sr) {
+    BoardMask mask = 0;
+    for (int i = 0; i < sr.lstgri_size(); ++i) {
+      const auto& gri = sr.lstgri(i);
+      for (int j = 0; j < gri.lstpos_size(); ++j) {
+        mask |= getPosMask(getIndex(gri.lstpos(j).x(), gri.lstpos(j).y()));
+      }
+    }
+
+    return mask;
+  }
+
+  // getColumnMask - all positions of column x
+  static BoardMask getColumnMask(int x) {
+    BoardMask mask = 0;
+    for (int y = 0; y < Height; ++y) {
+      mask |= getPosMask(getIndex(x, y));
+    }
+
+    return mask;
+  }
+
+ protected:
+  static constexpr BoardNeighborTable<Width, Height> s_neighbors =
+      BoardNeighborTable<Width, Height>();
+
+  BoardMask m_lstMask[MaxSymbols];
+  BoardMask m_otherMask;
+  SymbolType m_lstSymbol[Size];
+};
+
+// PrevBoardResult - the result of the last cascade step and the positions
+//                   changed since then, for the incremental evaluators
+//                 - prev 必须是完整算过的结果，提前返回的（比如 TLOD 触发
+//                   免费游戏那一步）不能用
+template <class SymbolBlockT, class SymbolMaskT>
+struct PrevBoardResult {
+  const ::natashapb::SpinResult* pResult;
+  SymbolMaskT masks;
+  BoardMask dirty;
+
+  PrevBoardResult() : pResult(NULL), dirty(0) {}
+
+  // build - prevArr is the board of prev, curMasks is the new board
+  void build(const ::natashapb::SpinResult& prev, const SymbolBlockT& prevArr,
+             const SymbolMaskT& curMasks) {
+    pResult = &prev;
+    masks.build(prevArr);
+    dirty = curMasks.getChangedMask(masks);
+  }
+
+  bool isDirty(int i) const {
+    return (dirty & SymbolMaskT::getPosMask(i)) != 0;
+  }
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_SYMBOLMASK_H__
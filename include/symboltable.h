@@ -0,0 +1,118 @@
+#ifndef __NATASHA_SYMBOLTABLE_H__
+#define __NATASHA_SYMBOLTABLE_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include "utils.h"
+
+namespace natasha {
+
+// symbol class bits
+const uint8_t SYMBOLCLASS_WILD = 0x01;
+const uint8_t SYMBOLCLASS_SCATTER = 0x02;
+
+// SYMBOLCLASS_TABLESIZE - symbols in SymbolClassTable, matches is uint32_t
+const int SYMBOLCLASS_TABLESIZE = 32;
+
+// SymbolClassTable - symbol classes and isSameSymbol_OnLine of GameCfgT,
+//                    built at compile time
+//   GameCfgT - static const int MaxSymbols
+//            - static constexpr bool isSameSymbol_OnLine(SymbolType s0,
+//                                                        SymbolType s1)
+//            - static constexpr bool isScatter(SymbolType s)
+//            - static constexpr bool isWild(SymbolType s)
+//   matches[s0] 的第 s1 位就是 isSameSymbol_OnLine(s0, s1)
+//   表里是 0 到 SYMBOLCLASS_TABLESIZE - 1，超过 MaxSymbols 的也按 GameCfgT 算，
+//   这样 isValid 只要一次比较
+template <class GameCfgT>
+struct SymbolClassTable {
+  static_assert(GameCfgT::MaxSymbols > 0 &&
+                    GameCfgT::MaxSymbols <= SYMBOLCLASS_TABLESIZE,
+                "matches is a uint32_t bit matrix");
+
+  uint8_t lstClass[SYMBOLCLASS_TABLESIZE];
+  uint32_t matches[SYMBOLCLASS_TABLESIZE];
+
+  constexpr SymbolClassTable() : lstClass(), matches() {
+    for (int s0 = 0; s0 < SYMBOLCLASS_TABLESIZE; ++s0) {
+      uint8_t cls = 0;
+      if (GameCfgT::isWild(s0)) {
+        cls |= SYMBOLCLASS_WILD;
+      }
+
+      if (GameCfgT::isScatter(s0)) {
+        cls |= SYMBOLCLASS_SCATTER;
+      }
+
+      lstClass[s0] = cls;
+
+      uint32_t mask = 0;
+      for (int s1 = 0; s1 < SYMBOLCLASS_TABLESIZE; ++s1) {
+        if (GameCfgT::isSameSymbol_OnLine(s0, s1)) {
+          mask |= ((uint32_t)1) << s1;
+        }
+      }
+
+      matches[s0] = mask;
+    }
+  }
+
+  // isValid - is s in the table, false for negative s
+  static constexpr bool isValid(SymbolType s) {
+    return (uint32_t)s < (uint32_t)SYMBOLCLASS_TABLESIZE;
+  }
+
+  // isValid - are s0 and s1 in the table
+  static constexpr bool isValid(SymbolType s0, SymbolType s1) {
+    return ((uint32_t)s0 | (uint32_t)s1) < (uint32_t)SYMBOLCLASS_TABLESIZE;
+  }
+};
+
+// SymbolClass - GameCfgT with table lookups, the same static interface as
+//               GameCfgT, so the evaluators take it as GameCfgT
+//             - 不在表里的 symbol（比如 -1 的空格）还是调用 GameCfgT
+template <class GameCfgT>
+struct SymbolClass {
+  typedef SymbolClassTable<GameCfgT> TableT;
+
+  static constexpr TableT table = TableT();
+
+  static bool isSameSymbol_OnLine(SymbolType s0, SymbolType s1) {
+    if (TableT::isValid(s0, s1)) {
+      return (table.matches[s0] >> s1) & 1;
+    }
+
+    return GameCfgT::isSameSymbol_OnLine(s0, s1);
+  }
+
+  static bool isSameSymbol_wild_OnLine(SymbolType s, SymbolType& curws) {
+    return GameCfgT::isSameSymbol_wild_OnLine(s, curws);
+  }
+
+  static bool isScatter(SymbolType s) {
+    if (TableT::isValid(s)) {
+      return table.lstClass[s] & SYMBOLCLASS_SCATTER;
+    }
+
+    return GameCfgT::isScatter(s);
+  }
+
+  static bool isWild(SymbolType s) {
+    if (TableT::isValid(s)) {
+      return table.lstClass[s] & SYMBOLCLASS_WILD;
+    }
+
+    return GameCfgT::isWild(s);
+  }
+
+  static int getMaxScstterNums(SymbolType s) {
+    return GameCfgT::getMaxScstterNums(s);
+  }
+};
+
+template <class GameCfgT>
+constexpr typename SymbolClass<GameCfgT>::TableT SymbolClass<GameCfgT>::table;
+
+}  // namespace natasha
+
+#endif  // __NATASHA_SYMBOLTABLE_H__
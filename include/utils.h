@@ -59,6 +59,11 @@ void clearGameResultInfo(::natashapb::GameResultInfo& gri);
 // clearSpinResult
 void clearSpinResult(::natashapb::SpinResult& sr);
 
+// applyBetToGameResult - win = mul * bet for lstgri[begin, end)
+//                      - 评估时只算倍数，最后才乘 bet，返回这些 gri 的 win 总和
+MoneyType applyBetToGameResult(::natashapb::SpinResult& sr, int begin,
+                               MoneyType bet);
+
 // setGameCtrlID
 void setGameCtrlID(::natashapb::GameCtrlID& dest,
                    const ::natashapb::GameCtrlID& parent, CtrlID curCtrlID,
@@ -0,0 +1,105 @@
+#ifndef __NATASHA_XOSHIRO256_H__
+#define __NATASHA_XOSHIRO256_H__
+
+#include <stdint.h>
+
+namespace natasha {
+
+// splitMix64 - next value of SplitMix64, used to seed xoshiro256**
+inline uint64_t splitMix64(uint64_t& x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Xoshiro256 - xoshiro256** 1.0
+//   只给模拟用（RTP 调参、benchmark），线上还是用 fortuna
+struct Xoshiro256 {
+  uint64_t s[4];
+
+  void seed(uint64_t seed) {
+    s[0] = splitMix64(seed);
+    s[1] = splitMix64(seed);
+    s[2] = splitMix64(seed);
+    s[3] = splitMix64(seed);
+  }
+
+  static inline uint64_t rotl(const uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  uint64_t next() {
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+
+    s[2] ^= t;
+
+    s[3] = rotl(s[3], 45);
+
+    return result;
+  }
+
+  // jump - the same as 2^128 next(), 2^128 non-overlapping streams
+  void jump() {
+    static const uint64_t JUMP[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+        0x39abdc4529b1661cULL};
+
+    jumpWith(JUMP);
+  }
+
+  // longJump - the same as 2^192 next()
+  void longJump() {
+    static const uint64_t LONG_JUMP[] = {
+        0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL,
+        0x39109bb02acbe635ULL};
+
+    jumpWith(LONG_JUMP);
+  }
+
+  // seedStream - stream of seed, seed() then jump() stream times
+  //            - 第 stream 个要 jump stream 次，很多个时用 jump 依次生成
+  void seedStream(uint64_t seed, uint64_t stream) {
+    this->seed(seed);
+
+    for (uint64_t i = 0; i < stream; ++i) {
+      jump();
+    }
+  }
+
+ protected:
+  void jumpWith(const uint64_t* pJump) {
+    uint64_t s0 = 0;
+    uint64_t s1 = 0;
+    uint64_t s2 = 0;
+    uint64_t s3 = 0;
+
+    for (int i = 0; i < 4; ++i) {
+      for (int b = 0; b < 64; ++b) {
+        if (pJump[i] & ((uint64_t)1) << b) {
+          s0 ^= s[0];
+          s1 ^= s[1];
+          s2 ^= s[2];
+          s3 ^= s[3];
+        }
+
+        next();
+      }
+    }
+
+    s[0] = s0;
+    s[1] = s1;
+    s[2] = s2;
+    s[3] = s3;
+  }
+};
+
+}  // namespace natasha
+
+#endif  // __NATASHA_XOSHIRO256_H__
@@ -386,6 +386,12 @@ startup_tricks(FState *st)
 	st->tricks_done = 1;
 }
 
+/*
+ * 0 when fortuna_reseed() is called by a background thread, then
+ * extract_data() never reseeds, and never calls gettimeofday().
+ */
+int			auto_reseed = 1;
+
 void
 extract_data(FState *st, unsigned count, uint8 *dst)
 {
@@ -393,7 +399,8 @@ extract_data(FState *st, unsigned count, uint8 *dst)
 	unsigned	block_nr = 0;
 
 	/* Should we reseed? */
-	if (st->pool0_bytes >= POOL0_FILL || st->reseed_count == 0)
+	if (auto_reseed &&
+		(st->pool0_bytes >= POOL0_FILL || st->reseed_count == 0))
 		if (enough_time_passed(st))
 			reseed(st);
 
@@ -447,6 +454,58 @@ fortuna_add_entropy(const uint8 *data, unsigned len)
 	add_entropy(&main_state, data, len);
 }
 
+#ifdef NATASHA_SIMULATION
+/*
+ * Reset state and seed it with fixed data.
+ *
+ * The reseed is forced here instead of waiting for enough_time_passed(),
+ * so the output only depends on the seed.  Only for benchmarks and
+ * reproducible simulations, never for a real game server, so it only
+ * exists when NATASHA_SIMULATION is defined.
+ */
+void
+fortuna_reset_with_seed(const uint8 *data, unsigned len)
+{
+	init_state(&main_state);
+	init_done = 1;
+	if (data && len)
+		add_entropy(&main_state, data, len);
+	reseed(&main_state);
+	gettimeofday(&main_state.last_reseed_time, NULL);
+}
+#endif /* NATASHA_SIMULATION */
+
+/*
+ * Reseed now if pool 0 has enough new entropy, without the time check,
+ * the caller decides how often.  Returns 1 if reseeded.
+ */
+int
+fortuna_reseed(void)
+{
+	if (!init_done)
+	{
+		init_state(&main_state);
+		init_done = 1;
+	}
+	if (main_state.pool0_bytes < POOL0_FILL && main_state.reseed_count != 0)
+		return 0;
+	reseed(&main_state);
+	gettimeofday(&main_state.last_reseed_time, NULL);
+	return 1;
+}
+
+void
+fortuna_set_auto_reseed(int enable)
+{
+	auto_reseed = enable;
+}
+
+unsigned
+fortuna_get_reseed_count(void)
+{
+	return main_state.reseed_count;
+}
+
 void
 fortuna_get_bytes(unsigned len, uint8 *dst)
 {
@@ -40,6 +40,12 @@ extern "C" {
 
 void		fortuna_get_bytes(unsigned len, uint8 *dst);
 void		fortuna_add_entropy(const uint8 *data, unsigned len);
+int			fortuna_reseed(void);
+void		fortuna_set_auto_reseed(int enable);
+unsigned	fortuna_get_reseed_count(void);
+#ifdef NATASHA_SIMULATION
+void		fortuna_reset_with_seed(const uint8 *data, unsigned len);
+#endif /* NATASHA_SIMULATION */
 
 #ifdef __cplusplus
 }
@@ -40,6 +40,7 @@
 
 #include "c.h"
 #include "sha2.h"
+#include "sha2ni.h"
 
 
 #if 0 /*def SHA2_USE_INTTYPES_H*/
@@ -143,11 +144,12 @@ typedef u_int64_t sha2_word64;	/* Exactly 8 bytes */
  * only.
  */
 static void SHA512_Last(SHA512_CTX*);
-static void SHA256_Transform(SHA256_CTX*, const sha2_word32*);
+static void SHA256_Transform(SHA256_CTX*, const uint8*);
+static void SHA256_Transform_Portable(SHA256_CTX*, const uint8*);
 static void SHA512_Transform(SHA512_CTX*, const sha2_word64*);
 
 /*** SHA-XYZ INITIAL HASH VALUES AND CONSTANTS ************************/
-/* Hash constant words K for SHA-256: */
+/* Hash constant words K for SHA-256, shared with sha2ni.c: */
 const sha2_word32 K256[64] = {
 	0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
 	0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
@@ -298,7 +300,7 @@ SHA256_Init(SHA256_CTX *context)
 } while(0)
 
 static void
-SHA256_Transform(SHA256_CTX *context, const sha2_word32 *data)
+SHA256_Transform_Portable(SHA256_CTX *context, const uint8 *data)
 {
 	sha2_word32		a,
 				b,
@@ -369,7 +371,7 @@ SHA256_Transform(SHA256_CTX *context, const sha2_word32 *data)
 #else							/* SHA2_UNROLL_TRANSFORM */
 
 static void
-SHA256_Transform(SHA256_CTX *context, const sha2_word32 *data)
+SHA256_Transform_Portable(SHA256_CTX *context, const uint8 *data)
 {
 	sha2_word32		a,
 				b,
@@ -458,6 +460,62 @@ SHA256_Transform(SHA256_CTX *context, const sha2_word32 *data)
 }
 #endif   /* SHA2_UNROLL_TRANSFORM */
 
+/*
+ * 1 if the SHA extensions are used, see sha2ni.c.  -1 until the first
+ * block, then it is checked once.  It is read and written with atomics,
+ * the first blocks of several threads may all run the cpuid check, but
+ * only the first result is kept, and SHA256_SetAccel() always wins.
+ */
+static int	sha256_accel = -1;
+
+static int
+sha256_get_accel(void)
+{
+	int			accel = __atomic_load_n(&sha256_accel, __ATOMIC_RELAXED);
+	int			expected = -1;
+
+	if (accel >= 0)
+		return accel;
+
+	accel = sha256_ni_supported();
+	if (!__atomic_compare_exchange_n(&sha256_accel, &expected, accel, 0,
+									 __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		accel = expected;
+
+	return accel;
+}
+
+static void
+SHA256_TransformBlocks(SHA256_CTX *context, const uint8 *data, size_t blocks)
+{
+	if (sha256_get_accel())
+	{
+		sha256_ni_transform(context->state, data, blocks);
+		return;
+	}
+
+	while (blocks--)
+	{
+		SHA256_Transform_Portable(context, data);
+		data += SHA256_BLOCK_LENGTH;
+	}
+}
+
+static void
+SHA256_Transform(SHA256_CTX *context, const uint8 *data)
+{
+	SHA256_TransformBlocks(context, data, 1);
+}
+
+int
+SHA256_SetAccel(int enable)
+{
+	int			accel = enable ? sha256_ni_supported() : 0;
+
+	__atomic_store_n(&sha256_accel, accel, __ATOMIC_RELAXED);
+	return accel;
+}
+
 void
 SHA256_Update(SHA256_CTX *context, const uint8 *data, size_t len)
 {
@@ -481,7 +539,7 @@ SHA256_Update(SHA256_CTX *context, const uint8 *data, size_t len)
 			context->bitcount += freespace << 3;
 			len -= freespace;
 			data += freespace;
-			SHA256_Transform(context, (sha2_word32*)context->buffer);
+			SHA256_Transform(context, context->buffer);
 		}
 		else
 		{
@@ -493,13 +551,15 @@ SHA256_Update(SHA256_CTX *context, const uint8 *data, size_t len)
 			return;
 		}
 	}
-	while (len >= SHA256_BLOCK_LENGTH)
+	if (len >= SHA256_BLOCK_LENGTH)
 	{
-		/* Process as many complete blocks as we can */
-		SHA256_Transform(context, (const sha2_word32*)data);
-		context->bitcount += SHA256_BLOCK_LENGTH << 3;
-		len -= SHA256_BLOCK_LENGTH;
-		data += SHA256_BLOCK_LENGTH;
+		/* Process as many complete blocks as we can, in one call */
+		size_t		blocks = len / SHA256_BLOCK_LENGTH;
+
+		SHA256_TransformBlocks(context, data, blocks);
+		context->bitcount += (uint64) blocks * SHA256_BLOCK_LENGTH << 3;
+		len -= blocks * SHA256_BLOCK_LENGTH;
+		data += blocks * SHA256_BLOCK_LENGTH;
 	}
 	if (len > 0)
 	{
@@ -538,7 +598,7 @@ SHA256_Last(SHA256_CTX *context)
 				memset(&context->buffer[usedspace], 0, SHA256_BLOCK_LENGTH - usedspace);
 			}
 			/* Do second-to-last transform: */
-			SHA256_Transform(context, (sha2_word32*)context->buffer);
+			SHA256_Transform(context, context->buffer);
 
 			/* And set-up for the last transform: */
 			memset(context->buffer, 0, SHA256_SHORT_BLOCK_LENGTH);
@@ -556,7 +616,7 @@ SHA256_Last(SHA256_CTX *context)
 	*(sha2_word64 *) &context->buffer[SHA256_SHORT_BLOCK_LENGTH] = context->bitcount;
 
 	/* Final transform: */
-	SHA256_Transform(context, (sha2_word32*)context->buffer);
+	SHA256_Transform(context, context->buffer);
 }
 
 void
@@ -44,6 +44,7 @@
 #define SHA256_Init pg_SHA256_Init
 #define SHA256_Update pg_SHA256_Update
 #define SHA256_Final pg_SHA256_Final
+#define SHA256_SetAccel pg_SHA256_SetAccel
 #define SHA384_Init pg_SHA384_Init
 #define SHA384_Update pg_SHA384_Update
 #define SHA384_Final pg_SHA384_Final
@@ -91,6 +92,12 @@ void		SHA256_Init(SHA256_CTX *);
 void		SHA256_Update(SHA256_CTX *, const uint8 *, size_t);
 void		SHA256_Final(uint8[SHA256_DIGEST_LENGTH], SHA256_CTX *);
 
+/*
+ * Use the x86 SHA extensions if the cpu has them (the default), or the
+ * portable transform.  Returns 1 if the SHA extensions are used.
+ */
+int			SHA256_SetAccel(int enable);
+
 void		SHA384_Init(SHA384_CTX *);
 void		SHA384_Update(SHA384_CTX *, const uint8 *, size_t);
 void		SHA384_Final(uint8[SHA384_DIGEST_LENGTH], SHA384_CTX *);
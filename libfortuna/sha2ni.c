@@ -0,0 +1,125 @@
+/*
+ * sha2ni.c
+ *		SHA-256 block transform with the x86 SHA extensions.
+ *
+ * The state is the same as SHA256_CTX.state (a..h in host order), and
+ * data is whole big-endian 64 bytes blocks, so it can replace
+ * SHA256_Transform() in sha2.c.  sha2.c checks sha256_ni_supported()
+ * once and falls back to the portable transform without it.
+ *
+ * Only the target attribute is used, the file builds without any
+ * -msha flag, and the instructions run only after the cpuid check.
+ */
+
+#include "c.h"
+#include "sha2.h"
+#include "sha2ni.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+int
+sha256_ni_supported(void)
+{
+	unsigned	eax,
+				ebx,
+				ecx,
+				edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+
+	/* SSSE3 and SSE4.1 */
+	if (!(ecx & (1 << 9)) || !(ecx & (1 << 19)))
+		return 0;
+
+	if (__get_cpuid_max(0, NULL) < 7)
+		return 0;
+
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+	/* SHA */
+	return (ebx & (1 << 29)) != 0;
+}
+
+__attribute__((target("sha,sse4.1,ssse3")))
+void
+sha256_ni_transform(uint32 *state, const uint8 *data, size_t blocks)
+{
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+										0x0405060700010203ULL);
+	__m128i		state0,
+				state1,
+				abef,
+				cdgh,
+				msg,
+				tmp;
+	__m128i		w[4];
+	int			i;
+
+	/* a b c d, e f g h -> a b e f, c d g h */
+	tmp = _mm_loadu_si128((const __m128i *) &state[0]);
+	state1 = _mm_loadu_si128((const __m128i *) &state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);
+	state1 = _mm_shuffle_epi32(state1, 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	while (blocks--)
+	{
+		abef = state0;
+		cdgh = state1;
+
+		/* 16 groups of 4 rounds, w[i & 3] is words 4i .. 4i + 3 */
+		for (i = 0; i < 16; i++)
+		{
+			if (i < 4)
+				w[i] = _mm_shuffle_epi8(
+					_mm_loadu_si128((const __m128i *) (data + i * 16)), MASK);
+			else
+			{
+				tmp = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+				tmp = _mm_add_epi32(tmp,
+					_mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+				w[i & 3] = _mm_sha256msg2_epu32(tmp, w[(i + 3) & 3]);
+			}
+
+			msg = _mm_add_epi32(w[i & 3],
+				_mm_loadu_si128((const __m128i *) &K256[i * 4]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+
+		data += SHA256_BLOCK_LENGTH;
+	}
+
+	/* a b e f, c d g h -> a b c d, e f g h */
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+	_mm_storeu_si128((__m128i *) &state[0], state0);
+	_mm_storeu_si128((__m128i *) &state[4], state1);
+}
+
+#else							/* __x86_64__ || __i386__ */
+
+int
+sha256_ni_supported(void)
+{
+	return 0;
+}
+
+void
+sha256_ni_transform(uint32 *state, const uint8 *data, size_t blocks)
+{
+}
+
+#endif   /* __x86_64__ || __i386__ */
@@ -0,0 +1,21 @@
+/*
+ * sha2ni.h
+ *		Private interface between sha2.c and sha2ni.c, not installed and
+ *		not included outside libfortuna.
+ */
+
+#ifndef _SHA2NI_H
+#define _SHA2NI_H
+
+#include "c.h"
+
+/* the SHA-256 round constants of sha2.c, prefixed like sha2.h */
+#define K256 pg_sha256_K256
+
+extern const uint32 K256[64];
+
+int			sha256_ni_supported(void);
+void		sha256_ni_transform(uint32 *state, const uint8 *data,
+								size_t blocks);
+
+#endif   /* _SHA2NI_H */
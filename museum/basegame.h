@@ -26,6 +26,11 @@ class MuseumBaseGame : public SlotsGameMod {
  public:
   virtual ::natashapb::CODE init() { return ::natashapb::OK; }
 
+  // setWaysCache - set the result cache of ways
+  void setWaysCache(const ThreadBoardResultCache3X5& cache) {
+    m_waysCache = cache;
+  }
+
   // onUserComeIn -
   virtual ::natashapb::CODE onUserComeIn(const UserInfo* pUser,
                                          ::natashapb::UserGameModInfo* pUGMI) {
@@ -104,19 +109,12 @@ class MuseumBaseGame : public SlotsGameMod {
       ::natashapb::RandomResult* pRandomResult,
       const ::natashapb::GameCtrl* pGameCtrl,
       const ::natashapb::UserGameModInfo* pUGMI, const UserInfo* pUser) {
-    auto turnnums = pUGMI->cascadinginfo().turnnums();
-    auto pCfg = (const ::natashapb::MuseumRTPConfig*)getUserConfig(pUser);
-    if (turnnums >= pCfg->bgmysterywild_size()) {
-      turnnums = pCfg->bgmysterywild_size() - 1;
-    }
-
-    auto mwweight = pCfg->bgmysterywild(turnnums);
+    auto pCfg = (const MuseumGameConfig*)getUserConfig(pUser);
+    const auto& mwweight = MuseumConfig<::natashapb::BASE_GAME>::getMysteryWild(
+        *pCfg, pUGMI->cascadinginfo().turnnums());
 
-    FuncOnFillReels f =
-        std::bind(museum_onfill, std::placeholders::_1, std::placeholders::_2,
-                  std::placeholders::_3, mwweight);
-
-    randomReels3x5(m_reels, pRandomResult, pUGMI, f);
+    randomReels3x5Batch(m_reels, pRandomResult, pUGMI,
+                        MuseumMysteryWildFill(mwweight));
 
     return ::natashapb::OK;
   }
@@ -133,7 +131,7 @@ class MuseumBaseGame : public SlotsGameMod {
     assert(pUGMI != NULL);
     assert(pUser != NULL);
 
-    auto pCfg = (const ::natashapb::MuseumRTPConfig*)getUserConfig(pUser);
+    auto pCfg = (const MuseumGameConfig*)getUserConfig(pUser);
 
 #ifdef NATASHA_DEBUG
     printRandomResult("countSpinResult", pRandomResult, MUSEUM_SYMBOL_MAPPING);
@@ -145,30 +143,31 @@ class MuseumBaseGame : public SlotsGameMod {
                                      pRandomResult, pUser, pCfg);
 
     // First check free
+    MuseumSymbolMask masks;
+    masks.build(pSpinResult->symbolblock().sb3x5());
+
     ::natashapb::GameResultInfo gri;
-    MuseumCountScatter(gri, pSpinResult->symbolblock().sb3x5(), m_paytables,
-                       MUSEUM_SYMBOL_S, pGameCtrl->spin().totalbet());
+    MuseumCountScatterMask(gri, masks, m_paytables, MUSEUM_SYMBOL_S,
+                           pGameCtrl->spin().totalbet());
     if (gri.typegameresult() == ::natashapb::SCATTER_LEFT) {
       auto pCurGRI = pSpinResult->add_lstgri();
       pCurGRI->CopyFrom(gri);
-      pSpinResult->set_fgnums(pCfg->fgnums());
+      pSpinResult->set_fgnums(pCfg->fgNums);
 
       pSpinResult->set_win(pSpinResult->win() + pCurGRI->win());
     }
 
     // check all line payout
-    MuseumCountWays(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
-                    m_paytables, pGameCtrl->spin().bet());
+    MuseumCountWaysCache(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
+                         m_paytables, pGameCtrl->spin().bet(),
+                         m_waysCache.get());
 
     auto bonuswin = museum_procWildBomb<::natashapb::BASE_GAME>(
-        pGameCtrl->spin().bet(), *pCfg, pUGMI, pSpinResult);
-
-    auto turnnums = pUGMI->cascadinginfo().turnnums();
-    if (turnnums >= pCfg->bgmultipliers_size()) {
-      turnnums = pCfg->bgmultipliers_size() - 1;
-    }
+        pGameCtrl->spin().bet(), *pCfg, pUGMI, masks, pSpinResult);
 
-    pSpinResult->set_awardmul(pCfg->bgmultipliers(turnnums));
+    pSpinResult->set_awardmul(
+        MuseumConfig<::natashapb::BASE_GAME>::getMultiplier(
+            *pCfg, pUGMI->cascadinginfo().turnnums()));
     pSpinResult->set_realwin(pSpinResult->win() * pSpinResult->awardmul() +
                              bonuswin);
 
@@ -319,7 +318,7 @@ class MuseumBaseGame : public SlotsGameMod {
     auto sb = pSpinResult->mutable_symbolblock();
     auto sb3x5 = sb->mutable_sb3x5();
 
-    auto cfg = (const ::natashapb::MuseumRTPConfig*)pCfg;
+    auto cfg = (const MuseumGameConfig*)pCfg;
     if (cfg != NULL) {
       auto turnnums = pUGMI->cascadinginfo().turnnums();
 #ifdef NATASHA_DEBUG
@@ -513,6 +512,7 @@ class MuseumBaseGame : public SlotsGameMod {
   Paytables3X5& m_paytables;
   BetList& m_lstBet;
   ::natashapb::MuseumConfig& m_cfg;
+  ThreadBoardResultCache3X5 m_waysCache;
 };
 
 }  // namespace natasha
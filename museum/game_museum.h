@@ -17,6 +17,9 @@ const int MUSEUM_DEFAULT_TIMES = 1;
 
 // const int MUSEUM_DEFAULT_FREENUMS = 10;
 
+// turnnums in markov chain, the longer cascades share the last key
+const int MUSEUM_MARKOV_MAXTURNNUMS = 15;
+
 const SymbolType MUSEUM_SYMBOL_W = 0;
 const SymbolType MUSEUM_SYMBOL_S = 10;
 
@@ -26,7 +29,9 @@ const int MeseumMaxPayoutNums = 5;
 const char MUSEUM_SYMBOL_MAPPING[] = " wabcdefghjs";
 
 struct MuseumGameCfg {
-  static bool isSameSymbol_OnLine(SymbolType s0, SymbolType s1) {
+  static const int MaxSymbols = MeseumMaxSymbols;
+
+  static constexpr bool isSameSymbol_OnLine(SymbolType s0, SymbolType s1) {
     if (s0 == MUSEUM_SYMBOL_S || s1 == MUSEUM_SYMBOL_S) {
       return false;
     }
@@ -52,29 +57,92 @@ struct MuseumGameCfg {
     return s == curws || s == MUSEUM_SYMBOL_W;
   }
 
-  static bool isScatter(SymbolType s) { return s == MUSEUM_SYMBOL_S; }
+  static constexpr bool isScatter(SymbolType s) {
+    return s == MUSEUM_SYMBOL_S;
+  }
 
-  static bool isWild(SymbolType s) { return s == MUSEUM_SYMBOL_W; }
+  static constexpr bool isWild(SymbolType s) { return s == MUSEUM_SYMBOL_W; }
 
   static int getMaxScstterNums(SymbolType s) { return MUSEUM_WIDTH; }
 };
 
+// MuseumSymbolClass - MuseumGameCfg with the symbol class tables
+//   - 算分的都用它，规则还是写在 MuseumGameCfg 里
+typedef SymbolClass<MuseumGameCfg> MuseumSymbolClass;
+
 auto const MuseumCountScatter =
     &countScatter_Left<MoneyType, SymbolType, MUSEUM_WIDTH, MUSEUM_HEIGHT,
-                       ::natashapb::SymbolBlock3X5, MuseumGameCfg>;
+                       ::natashapb::SymbolBlock3X5, MuseumSymbolClass>;
+
+// MuseumSymbolMask - masks of the symbols on a board
+typedef SymbolMask<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH, MUSEUM_HEIGHT,
+                   MeseumMaxSymbols>
+    MuseumSymbolMask;
+
+auto const MuseumCountScatterMask =
+    &countScatter_Left_Mask<MoneyType, SymbolType, MUSEUM_WIDTH, MUSEUM_HEIGHT,
+                            MuseumSymbolMask, MuseumSymbolClass>;
 
 auto const MuseumCountWays =
     &countFullWays5_Left<MoneyType, SymbolType, MUSEUM_HEIGHT,
-                         ::natashapb::SymbolBlock3X5, MuseumGameCfg>;
+                         ::natashapb::SymbolBlock3X5, MuseumSymbolClass>;
+
+auto const MuseumCountWaysCache =
+    &countFullWays5_Left_Cache<MoneyType, SymbolType, MUSEUM_HEIGHT,
+                               ::natashapb::SymbolBlock3X5, MuseumSymbolClass>;
+
+// MuseumModRTPConfig - compiled rtp config of base game or free game
+//   按 turnnums 取值，超出的都用最后一个
+struct MuseumModRTPConfig {
+  std::vector<int> lstBonusPrize;
+  std::vector<int> lstMultiplier;
+  std::vector<WeightTable> lstMysteryWild;
+
+  int getBonusPrize(int turnnums) const {
+    if (turnnums >= (int)lstBonusPrize.size()) {
+      turnnums = lstBonusPrize.size() - 1;
+    }
+
+    return lstBonusPrize[turnnums];
+  }
+
+  int getMultiplier(int turnnums) const {
+    if (turnnums >= (int)lstMultiplier.size()) {
+      turnnums = lstMultiplier.size() - 1;
+    }
+
+    return lstMultiplier[turnnums];
+  }
+
+  const WeightTable& getMysteryWild(int turnnums) const {
+    if (turnnums >= (int)lstMysteryWild.size()) {
+      turnnums = lstMysteryWild.size() - 1;
+    }
+
+    return lstMysteryWild[turnnums];
+  }
+};
+
+// MuseumGameConfig - compiled MuseumRTPConfig, immutable after compiled
+//                  - UserInfo::pCurConfig 指向它，MuseumRTPConfig 只用来加载
+struct MuseumGameConfig {
+  int fgNums;
+  MuseumModRTPConfig bg;
+  MuseumModRTPConfig fg;
+};
+
+// compileMuseumRTPConfig - MuseumRTPConfig -> MuseumGameConfig
+::natashapb::CODE compileMuseumRTPConfig(
+    const ::natashapb::MuseumRTPConfig& rtpcfg, MuseumGameConfig& cfg);
 
 // callback function in fill
 static SymbolType museum_onfill(int x, int y, SymbolType s,
-                                const ::natashapb::WeightConfig& weightcfg) {
+                                const WeightTable& weight) {
   if (x == 0 || s == MUSEUM_SYMBOL_S) {
     return s;
   }
 
-  auto cr = randWeightConfig(weightcfg);
+  auto cr = randWeightTable(weight);
   if (cr == 0) {
     return MUSEUM_SYMBOL_W;
   }
@@ -82,117 +150,112 @@ static SymbolType museum_onfill(int x, int y, SymbolType s,
   return s;
 }
 
-template <::natashapb::GAMEMODTYPE GameModType>
-class MuseumConfig {
- public:
-  static int getBonusPrize(const ::natashapb::MuseumRTPConfig cfg,
-                           int turnnums);
+// MuseumMysteryWildFill - fill policy of mystery wild, same as museum_onfill
+//   可以用在 randomReels3x5T 和 randomReels3x5Batch
+struct MuseumMysteryWildFill {
+  const WeightTable& weight;
 
-  static const ::natashapb::WeightConfig& getMysteryWild(
-      const ::natashapb::MuseumRTPConfig cfg, int index);
-};
+  explicit MuseumMysteryWildFill(const WeightTable& w) : weight(w) {}
 
-template <>
-class MuseumConfig<::natashapb::BASE_GAME> {
- public:
-  static int getBonusPrize(const ::natashapb::MuseumRTPConfig cfg,
-                           int turnnums) {
-    if (turnnums >= cfg.bgbonusprize_size()) {
-      turnnums = cfg.bgbonusprize_size() - 1;
-    }
+  SymbolType onFill(int x, int y, SymbolType s) const {
+    return museum_onfill(x, y, s, weight);
+  }
 
-    return cfg.bgbonusprize(turnnums);
+  bool needRandom(int x, int y, SymbolType s) const {
+    return x != 0 && s != MUSEUM_SYMBOL_S;
   }
 
-  static const ::natashapb::WeightConfig& getMysteryWild(
-      const ::natashapb::MuseumRTPConfig cfg, int index) {
-    return cfg.bgmysterywild(index);
+  uint32_t getRandomRange() const { return weight.totalWeight; }
+
+  // onRandom - weight 0 is wild
+  SymbolType onRandom(int x, int y, SymbolType s, uint32_t cr) const {
+    return !weight.lstWeight.empty() && cr < (uint32_t)weight.lstWeight[0]
+               ? MUSEUM_SYMBOL_W
+               : s;
   }
 };
 
-template <>
-class MuseumConfig<::natashapb::FREE_GAME> {
+template <::natashapb::GAMEMODTYPE GameModType>
+class MuseumConfig {
  public:
-  static int getBonusPrize(const ::natashapb::MuseumRTPConfig cfg,
-                           int turnnums) {
-    if (turnnums >= cfg.fgbonusprize_size()) {
-      turnnums = cfg.fgbonusprize_size() - 1;
-    }
+  static const MuseumModRTPConfig& getModConfig(const MuseumGameConfig& cfg);
 
-    return cfg.fgbonusprize(turnnums);
+  static int getBonusPrize(const MuseumGameConfig& cfg, int turnnums) {
+    return getModConfig(cfg).getBonusPrize(turnnums);
   }
 
-  static const ::natashapb::WeightConfig& getMysteryWild(
-      const ::natashapb::MuseumRTPConfig cfg, int index) {
-    return cfg.fgmysterywild(index);
+  static const WeightTable& getMysteryWild(const MuseumGameConfig& cfg,
+                                           int turnnums) {
+    return getModConfig(cfg).getMysteryWild(turnnums);
   }
-};
 
-// bomb
-static void museum_bomb(::natashapb::SymbolBlock3X5& tmp,
-                        const ::natashapb::SymbolBlock3X5& sb3x5, int x, int y,
-                        ::natashapb::GameResultInfo* pGRI) {
-  // printf("bomb %d %d\n", x, y);
-  for (int cy = y - 1; cy <= y + 1; ++cy) {
-    if (cy >= 0 && cy < MUSEUM_HEIGHT) {
-      for (int cx = x - 1; cx <= x + 1; ++cx) {
-        if (cx >= 0 && cx < MUSEUM_WIDTH) {
-          auto ctmps = getSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                                      MUSEUM_HEIGHT>(&tmp, cx, cy);
-          if (ctmps == 0) {
-            if (cx == x && cy == y) {
-              auto cp = pGRI->add_lstpos();
-              cp->set_x(cx);
-              cp->set_y(cy);
-
-              setSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                             MUSEUM_HEIGHT>(&tmp, cx, cy, -1);
-            } else {
-              auto cs =
-                  getSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                                 MUSEUM_HEIGHT>(&sb3x5, cx, cy);
-
-              if (cs != MUSEUM_SYMBOL_W && cs != MUSEUM_SYMBOL_S) {
-                auto cp = pGRI->add_lstpos();
-                cp->set_x(cx);
-                cp->set_y(cy);
-
-                setSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                               MUSEUM_HEIGHT>(&tmp, cx, cy, -1);
-              }
-            }
-          }
-        }
-      }
-    }
+  static int getMultiplier(const MuseumGameConfig& cfg, int turnnums) {
+    return getModConfig(cfg).getMultiplier(turnnums);
   }
+};
+
+template <>
+inline const MuseumModRTPConfig&
+MuseumConfig<::natashapb::BASE_GAME>::getModConfig(
+    const MuseumGameConfig& cfg) {
+  return cfg.bg;
 }
 
+template <>
+inline const MuseumModRTPConfig&
+MuseumConfig<::natashapb::FREE_GAME>::getModConfig(
+    const MuseumGameConfig& cfg) {
+  return cfg.fg;
+}
+
+// museum_bomb - positions bombed by the wild of index i
+//             - removed 是已经消掉的位置，wild 自己没消掉也会炸掉，
+//               周围的 W 和 S 不炸
+inline BoardMask museum_bomb(BoardMask removed, BoardMask removable, int i) {
+  return MuseumSymbolMask::getNeighborMask(i) & ~removed &
+         (removable | MuseumSymbolMask::getPosMask(i));
+}
+
+// museum_procWildBomb - bomb all wilds not in the first reel
+//                     - masks 是 pSpinResult 的盘面
 template <::natashapb::GAMEMODTYPE GameModType>
-MoneyType museum_procWildBomb(MoneyType bet,
-                              const ::natashapb::MuseumRTPConfig& cfg,
+MoneyType museum_procWildBomb(MoneyType bet, const MuseumGameConfig& cfg,
                               const ::natashapb::UserGameModInfo* pUser,
+                              const MuseumSymbolMask& masks,
                               ::natashapb::SpinResult* pSpinResult) {
   if (pSpinResult->specialtriggered() > 0) {
-    ::natashapb::SymbolBlock3X5 tmp;
-    auto sb3x5 = pSpinResult->symbolblock().sb3x5();
-    auto pGRI = pSpinResult->add_lstgri();
-
-    removeBlock3X5WithGameResult(&tmp, pSpinResult);
-
-    for (int y = 0; y < MUSEUM_HEIGHT; ++y) {
-      for (int x = 1; x < MUSEUM_WIDTH; ++x) {
-        auto ctmps = getSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                                    MUSEUM_HEIGHT>(&tmp, x, y);
-        auto cs = getSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
-                                 MUSEUM_HEIGHT>(&sb3x5, x, y);
-        if (cs == MUSEUM_SYMBOL_W) {
-          museum_bomb(tmp, sb3x5, x, y, pGRI);
-        }
+    BoardMask wmask = masks.getMask(MUSEUM_SYMBOL_W) &
+                      ~MuseumSymbolMask::getColumnMask(0);
+    if (wmask == 0) {
+      return 0;
+    }
+
+    BoardMask removed = MuseumSymbolMask::buildResultMask(*pSpinResult);
+    BoardMask removable =
+        ~(masks.getMask(MUSEUM_SYMBOL_W) | masks.getMask(MUSEUM_SYMBOL_S));
+
+    // 按 wild 的顺序，每个 wild 炸掉的位置从小到大
+    int lstBomb[MuseumSymbolMask::Size];
+    int bombnums = 0;
+
+    while (wmask != 0) {
+      BoardMask bomb = museum_bomb(removed, removable, popBoardMask(wmask));
+      removed |= bomb;
+
+      while (bomb != 0) {
+        lstBomb[bombnums++] = popBoardMask(bomb);
       }
     }
 
-    if (pGRI->lstpos_size() > 0) {
+    if (bombnums > 0) {
+      auto pGRI = pSpinResult->add_lstgri();
+
+      for (int i = 0; i < bombnums; ++i) {
+        auto cp = pGRI->add_lstpos();
+        cp->set_x(MuseumSymbolMask::getX(lstBomb[i]));
+        cp->set_y(MuseumSymbolMask::getY(lstBomb[i]));
+      }
+
       auto turnnums = pUser->cascadinginfo().turnnums();
 
       pGRI->set_mul(MuseumConfig<GameModType>::getBonusPrize(cfg, turnnums));
@@ -201,8 +264,6 @@ MoneyType museum_procWildBomb(MoneyType bet,
       pGRI->set_realwin(pGRI->win());
 
       return pGRI->realwin();
-    } else {
-      pSpinResult->mutable_lstgri()->RemoveLast();
     }
   }
 
@@ -210,12 +271,12 @@ MoneyType museum_procWildBomb(MoneyType bet,
 };
 
 template <::natashapb::GAMEMODTYPE GameModType>
-int museum_randWArr(const ::natashapb::MuseumRTPConfig& cfg,
+int museum_randWArr(const MuseumGameConfig& cfg,
                     const ::natashapb::SymbolBlock3X5& srcsb3x5,
                     ::natashapb::SymbolBlock3X5* sb3x5) {
   int nums = 0;
 
-  auto mwweight = MuseumConfig<GameModType>::getMysteryWild(cfg, 0);
+  const auto& mwweight = MuseumConfig<GameModType>::getMysteryWild(cfg, 0);
 
   for (int y = 0; y < MUSEUM_HEIGHT; ++y) {
     setSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH, MUSEUM_HEIGHT>(
@@ -227,7 +288,7 @@ int museum_randWArr(const ::natashapb::MuseumRTPConfig& cfg,
       auto cs = getSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
                                MUSEUM_HEIGHT>(&srcsb3x5, x, y);
       if (cs != MUSEUM_SYMBOL_S) {
-        auto ci = randWeightConfig(mwweight);
+        auto ci = randWeightTable(mwweight);
         if (ci == 0) {
           setSymbolBlock<::natashapb::SymbolBlock3X5, MUSEUM_WIDTH,
                          MUSEUM_HEIGHT>(sb3x5, x, y, MUSEUM_SYMBOL_W);
@@ -186,6 +186,20 @@ void Museum::initConfig() {
   addGameMod(::natashapb::FREE_GAME,
              new MuseumFreeGame(*this, m_reels, m_paytables, m_lstBet, m_cfg));
 
+  clearGameConfig();
+
+  auto maprtp = m_cfg.mutable_rtp();
+  for (auto it = maprtp->begin(); it != maprtp->end(); ++it) {
+    MuseumGameConfig* pGameCfg = NULL;
+
+    auto code = newGameConfig(it->second, pGameCfg);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    m_mapGameConfig[it->first] = pGameCfg;
+  }
+
   return GameLogic::init(cfgpath);
 }
 
@@ -212,6 +226,322 @@ GameMod* Museum::getMainGameMod(UserInfo* pUser, bool isComeInGame) {
   return pBG;
 }
 
+// getRTPConfig - get rtp config with configname, NULL if not found
+//              - 只读，修改要用 setRTPConfig
+const ::natashapb::MuseumRTPConfig* Museum::getRTPConfig(
+    const char* configname) {
+  auto& maprtp = m_cfg.rtp();
+  auto it = maprtp.find(configname);
+  if (it != maprtp.end()) {
+    return &(it->second);
+  }
+
+  return NULL;
+}
+
+// setRTPConfig - replace the rtp config and compile it again
+//              - 编译一个新的 MuseumGameConfig 换进去，原来的不改，
+//                放到退役列表里，已经指向它的 UserInfo 还是用原来的，
+//                getGameConfig 拿到新的，releaseRetiredGameConfig 时释放
+//              - 不是线程安全的，不能和 gameCtrl 同时调用
+::natashapb::CODE Museum::setRTPConfig(
+    const char* configname, const ::natashapb::MuseumRTPConfig& rtpcfg) {
+  auto maprtp = m_cfg.mutable_rtp();
+  auto it = maprtp->find(configname);
+  if (it == maprtp->end()) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  auto itcfg = m_mapGameConfig.find(configname);
+  assert(itcfg != m_mapGameConfig.end());
+
+  // 失败了不影响原来的
+  MuseumGameConfig* pGameCfg = NULL;
+  auto code = newGameConfig(rtpcfg, pGameCfg);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  // 初始局面只给新的 config，旧的 config 会随机重试
+  releaseInitScenarios(::natashapb::BASE_GAME, itcfg->second);
+  m_lstRetiredGameConfig.push_back(itcfg->second);
+
+  it->second.CopyFrom(rtpcfg);
+  itcfg->second = pGameCfg;
+
+  return ::natashapb::OK;
+}
+
+// recompileRTPConfig - compile rtpcfg into the current MuseumGameConfig of
+//                      configname, without new initial scenarios
+//                    - 先编译到临时的，失败了不影响原来的
+::natashapb::CODE Museum::recompileRTPConfig(
+    const char* configname, const ::natashapb::MuseumRTPConfig& rtpcfg) {
+  auto maprtp = m_cfg.mutable_rtp();
+  auto it = maprtp->find(configname);
+  if (it == maprtp->end()) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  auto itcfg = m_mapGameConfig.find(configname);
+  assert(itcfg != m_mapGameConfig.end());
+
+  MuseumGameConfig cfg;
+  auto code = compileMuseumRTPConfig(rtpcfg, cfg);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  it->second.CopyFrom(rtpcfg);
+  *itcfg->second = std::move(cfg);
+
+  return ::natashapb::OK;
+}
+
+// getGameConfig - get compiled config with configname, NULL if not found
+//               - 用来设置 UserInfo::pCurConfig
+const MuseumGameConfig* Museum::getGameConfig(const char* configname) const {
+  auto it = m_mapGameConfig.find(configname);
+  if (it != m_mapGameConfig.end()) {
+    return it->second;
+  }
+
+  return NULL;
+}
+
+// newGameConfig - compile rtpcfg and build its initial scenarios
+::natashapb::CODE Museum::newGameConfig(
+    const ::natashapb::MuseumRTPConfig& rtpcfg, MuseumGameConfig*& pGameCfg) {
+  pGameCfg = new MuseumGameConfig();
+
+  auto code = compileMuseumRTPConfig(rtpcfg, *pGameCfg);
+  if (code == ::natashapb::OK) {
+    code = buildInitScenarios(::natashapb::BASE_GAME, pGameCfg);
+  }
+
+  if (code != ::natashapb::OK) {
+    releaseInitScenarios(::natashapb::BASE_GAME, pGameCfg);
+
+    delete pGameCfg;
+    pGameCfg = NULL;
+  }
+
+  return code;
+}
+
+// clearGameConfig - delete all compiled configs, and the retired ones
+void Museum::clearGameConfig() {
+  for (auto it = m_mapGameConfig.begin(); it != m_mapGameConfig.end(); ++it) {
+    releaseInitScenarios(::natashapb::BASE_GAME, it->second);
+
+    delete it->second;
+  }
+
+  m_mapGameConfig.clear();
+
+  releaseRetiredGameConfig();
+}
+
+// isRetiredGameConfig - is pCfg replaced by setRTPConfig
+bool Museum::isRetiredGameConfig(const void* pCfg) const {
+  for (auto it = m_lstRetiredGameConfig.begin();
+       it != m_lstRetiredGameConfig.end(); ++it) {
+    if (*it == pCfg) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// releaseRetiredGameConfig - delete the configs replaced by setRTPConfig
+//                          - 初始局面在 setRTPConfig 时已经释放了
+void Museum::releaseRetiredGameConfig() {
+  for (auto it = m_lstRetiredGameConfig.begin();
+       it != m_lstRetiredGameConfig.end(); ++it) {
+    delete *it;
+  }
+
+  m_lstRetiredGameConfig.clear();
+}
+
+// enableWaysCache - cache the ways result of maxNums boards, 0 is disabled
+void Museum::enableWaysCache(int maxNums) {
+  auto pBG = (MuseumBaseGame*)getGameMod(::natashapb::BASE_GAME);
+  assert(pBG != NULL);
+
+  auto pFG = (MuseumFreeGame*)getGameMod(::natashapb::FREE_GAME);
+  assert(pFG != NULL);
+
+  // 换一个 id，其他线程里旧的 cache 不会再用到
+  releaseThreadBoardResultCache<BoardResultCache3X5>(m_waysCache.id);
+
+  m_waysCache.id = newBoardResultCacheID();
+  m_waysCache.maxNums = maxNums;
+
+  pBG->setWaysCache(m_waysCache);
+  pFG->setWaysCache(m_waysCache);
+}
+
+// compileModRTPConfig - compile the rtp config of one game module
+static ::natashapb::CODE compileModRTPConfig(
+    const ::google::protobuf::RepeatedField< ::google::protobuf::int32>&
+        bonusprize,
+    const ::google::protobuf::RepeatedField< ::google::protobuf::int32>&
+        multipliers,
+    const ::google::protobuf::RepeatedPtrField< ::natashapb::WeightConfig>&
+        mysterywild,
+    MuseumModRTPConfig& cfg) {
+  if (bonusprize.size() <= 0 || multipliers.size() <= 0 ||
+      mysterywild.size() <= 0) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  cfg.lstBonusPrize.assign(bonusprize.begin(), bonusprize.end());
+  cfg.lstMultiplier.assign(multipliers.begin(), multipliers.end());
+
+  cfg.lstMysteryWild.clear();
+  cfg.lstMysteryWild.resize(mysterywild.size());
+  for (int i = 0; i < mysterywild.size(); ++i) {
+    if (!isValidWeightConfig(mysterywild.Get(i))) {
+      return ::natashapb::INVALID_REELS_CFG;
+    }
+
+    compileWeightConfig(mysterywild.Get(i), cfg.lstMysteryWild[i]);
+  }
+
+  return ::natashapb::OK;
+}
+
+// compileMuseumRTPConfig - MuseumRTPConfig -> MuseumGameConfig
+::natashapb::CODE compileMuseumRTPConfig(
+    const ::natashapb::MuseumRTPConfig& rtpcfg, MuseumGameConfig& cfg) {
+  cfg.fgNums = rtpcfg.fgnums();
+
+  auto code =
+      compileModRTPConfig(rtpcfg.bgbonusprize(), rtpcfg.bgmultipliers(),
+                          rtpcfg.bgmysterywild(), cfg.bg);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  return compileModRTPConfig(rtpcfg.fgbonusprize(), rtpcfg.fgmultipliers(),
+                             rtpcfg.fgmysterywild(), cfg.fg);
+}
+
+// buildCascadeTable_museum - sample cascade steps with the rtp config
+::natashapb::CODE buildCascadeTable_museum(Museum& museum,
+                                           const char* configname,
+                                           int64_t spinNums,
+                                           CascadeTable& table) {
+  ::natashapb::UserGameLogicInfo ugi;
+  UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)museum.getGameConfig(configname);
+  if (user.pCurConfig == NULL) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  ugi.set_configname(configname);
+
+  auto code = museum.userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::GameCtrl gamectrlBG;
+  auto spin = gamectrlBG.mutable_spin();
+  spin->set_bet(1);
+  spin->set_lines(MUSEUM_DEFAULT_PAY_LINES);
+  spin->set_times(MUSEUM_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl gamectrlFG;
+  auto freespin = gamectrlFG.mutable_freespin();
+  freespin->set_bet(1);
+  freespin->set_lines(MUSEUM_DEFAULT_PAY_LINES);
+  freespin->set_times(MUSEUM_DEFAULT_TIMES);
+
+  return sampleCascadeTable(
+      museum, &user, &gamectrlBG, &gamectrlFG, spinNums,
+      [](::natashapb::GAMEMODTYPE module,
+         const ::natashapb::UserGameModInfo* pUGMI) {
+        auto turnnums = pUGMI->cascadinginfo().turnnums();
+        if (turnnums > MUSEUM_MARKOV_MAXTURNNUMS) {
+          turnnums = MUSEUM_MARKOV_MAXTURNNUMS;
+        }
+
+        return turnnums;
+      },
+      table);
+}
+
+// solveRTP_museum - solve rtp with multipliers & bonusprize in cfg
+bool solveRTP_museum(const CascadeTable& table, const MuseumGameConfig& cfg,
+                     CascadeRTPResult& result) {
+  CascadeModel model;
+  model.isFGImmediately = false;
+
+  return solveCascadeRTP(
+      table, model,
+      [&cfg](::natashapb::GAMEMODTYPE module, int key,
+             const CascadeStep& step) {
+        if (module == ::natashapb::BASE_GAME) {
+          return step.getMeanWin() *
+                     MuseumConfig<::natashapb::BASE_GAME>::getMultiplier(cfg,
+                                                                         key) +
+                 step.getMeanBonus() *
+                     MuseumConfig<::natashapb::BASE_GAME>::getBonusPrize(cfg,
+                                                                         key);
+        }
+
+        return step.getMeanWin() *
+                   MuseumConfig<::natashapb::FREE_GAME>::getMultiplier(cfg,
+                                                                       key) +
+               step.getMeanBonus() *
+                   MuseumConfig<::natashapb::FREE_GAME>::getBonusPrize(cfg,
+                                                                       key);
+      },
+      result);
+}
+
+// countRTP_museum_markov - count rtp with markov chain
+void countRTP_museum_markov() {
+  Museum museum;
+
+  printf("%ld\n", time(NULL));
+
+  auto c = museum.init("./csv");
+  if (c != natashapb::OK) {
+    printf("init fail(%d)!\n", c);
+
+    return;
+  }
+
+  CascadeTable table;
+  c = buildCascadeTable_museum(museum, "rtp96", 1000000, table);
+  if (c != natashapb::OK) {
+    printf("buildCascadeTable_museum fail(%d)!\n", c);
+
+    return;
+  }
+
+  printf("sampled rtp is %.4f%%\n",
+         table.getTotalRealWin() / table.getSpinNums() * 100);
+
+  CascadeRTPResult result;
+  if (!solveRTP_museum(table, *museum.getGameConfig("rtp96"), result)) {
+    printf("solveRTP_museum fail!\n");
+
+    return;
+  }
+
+  outputCascadeRTPResult("museum", result);
+
+  printf("%ld\n", time(NULL));
+
+  printf("end!\n");
+}
+
 #ifdef NATASHA_COUNTRTP
 
 // countRTP_museum - count rtp
@@ -230,6 +560,7 @@ void countRTP_museum() {
   pUser->pLogicUser = pUGI;
 
   pUGI->set_configname("rtp96");
+  pUser->pCurConfig = (void*)museum.getGameConfig("rtp96");
 
   c = museum.userComeIn(pUser);
   if (c != natashapb::OK) {
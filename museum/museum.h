@@ -2,7 +2,10 @@
 #define __NATASHA_MUSEUM_H__
 
 #include <assert.h>
+#include <map>
+#include <string>
 #include <vector>
+#include "../include/cascadetable.h"
 #include "../include/game3x5.h"
 #include "../include/gamelogic.h"
 #include "basegame.h"
@@ -14,17 +17,94 @@ namespace natasha {
 // countRTP_museum - count rtp
 void countRTP_museum();
 
+// countRTP_museum_markov - count rtp with markov chain
+void countRTP_museum_markov();
+
+class Museum;
+
+// buildCascadeTable_museum - sample cascade steps with the rtp config
+::natashapb::CODE buildCascadeTable_museum(Museum& museum,
+                                           const char* configname,
+                                           int64_t spinNums,
+                                           CascadeTable& table);
+
+// solveRTP_museum - solve rtp with multipliers & bonusprize in cfg
+//                 - table 可以是其它 multipliers & bonusprize 采样的，
+//                   只要 mysterywild 相同，不需要重新采样
+bool solveRTP_museum(const CascadeTable& table, const MuseumGameConfig& cfg,
+                     CascadeRTPResult& result);
+
 // Museum
 class Museum : public GameLogic {
  public:
   Museum() {}
-  virtual ~Museum() {}
+  virtual ~Museum() {
+    clearGameConfig();
+
+    releaseThreadBoardResultCache<BoardResultCache3X5>(m_waysCache.id);
+  }
 
  public:
   virtual ::natashapb::CODE init(const char* cfgpath);
 
   // getMainGameMod - get current main game module
   virtual GameMod* getMainGameMod(UserInfo* pUser, bool isComeInGame);
+
+ public:
+  // getRTPConfig - get rtp config with configname, NULL if not found
+  //              - 只读，修改要用 setRTPConfig
+  const ::natashapb::MuseumRTPConfig* getRTPConfig(const char* configname);
+
+  // setRTPConfig - replace the rtp config and compile it again
+  //              - 换成新编译的 MuseumGameConfig，原来的不变，放到退役列表里，
+  //                每次调用多一个，releaseRetiredGameConfig 或 Museum 析构时
+  //                才释放，长期运行的服务器要定期释放
+  //              - 不是线程安全的，不能和 gameCtrl 同时调用
+  ::natashapb::CODE setRTPConfig(const char* configname,
+                                 const ::natashapb::MuseumRTPConfig& rtpcfg);
+
+  // isRetiredGameConfig - is pCfg replaced by setRTPConfig
+  //                     - UserInfo::pCurConfig 是退役的时，
+  //                       要重新 getGameConfig
+  bool isRetiredGameConfig(const void* pCfg) const;
+
+  // getRetiredGameConfigNums - nums of the configs replaced by setRTPConfig
+  int getRetiredGameConfigNums() const {
+    return m_lstRetiredGameConfig.size();
+  }
+
+  // releaseRetiredGameConfig - delete the configs replaced by setRTPConfig
+  //                          - 调用前要保证没有 UserInfo::pCurConfig 还指向
+  //                            它们，比如所有用户都换成 getGameConfig 的以后
+  //                          - 不是线程安全的，不能和 gameCtrl 同时调用
+  void releaseRetiredGameConfig();
+
+  // recompileRTPConfig - compile rtpcfg into the current MuseumGameConfig of
+  //                      configname, without new initial scenarios
+  //                    - 只给 tuning 用，不分配新的 config，也没有退役的 config，
+  //                      已经指向它的 UserInfo 马上用新的参数
+  //                    - 初始局面还是原来的，初始局面只是 userComeIn 时显示的
+  //                      盘面，第一次 spin 是新盘面，不影响结果
+  //                    - 不是线程安全的，不能和 gameCtrl 同时调用
+  ::natashapb::CODE recompileRTPConfig(
+      const char* configname, const ::natashapb::MuseumRTPConfig& rtpcfg);
+
+  // getGameConfig - get compiled config with configname, NULL if not found
+  //               - 用来设置 UserInfo::pCurConfig
+  const MuseumGameConfig* getGameConfig(const char* configname) const;
+
+  // enableWaysCache - cache the ways result of maxNums boards, 0 is disabled
+  //                 - 默认关闭，init 以后调用，BG 和 FG 共用一个
+  //                 - 每个线程一个 cache，不能和 gameCtrl 同时调用
+  //                 - Museum 的盘面是随机的，很少重复，实测命中率接近 0
+  void enableWaysCache(int maxNums);
+
+  // getWaysCache - the ways cache of current thread, NULL if disabled
+  const BoardResultCache3X5* getWaysCache() const { return m_waysCache.get(); }
+
+  const NormalReels3X5& getReels() const { return m_reels; }
+
+  const Paytables3X5& getPaytables() const { return m_paytables; }
 #ifdef NATASHA_COUNTRTP
  public:
   virtual void onInitRTP() {
@@ -57,11 +137,23 @@ class Museum : public GameLogic {
   void initConfig();
 #endif  // NATASHA_RUNINCPP
 
+ protected:
+  // newGameConfig - compile rtpcfg and build its initial scenarios
+  ::natashapb::CODE newGameConfig(const ::natashapb::MuseumRTPConfig& rtpcfg,
+                                  MuseumGameConfig*& pGameCfg);
+
+  // clearGameConfig - delete all compiled configs, and the retired ones
+  void clearGameConfig();
+
  protected:
   NormalReels3X5 m_reels;
   Paytables3X5 m_paytables;
   BetList m_lstBet;
   ::natashapb::MuseumConfig m_cfg;
+  std::map<std::string, MuseumGameConfig*> m_mapGameConfig;
+  // m_lstRetiredGameConfig - replaced by setRTPConfig, UserInfo may use them
+  std::vector<MuseumGameConfig*> m_lstRetiredGameConfig;
+  ThreadBoardResultCache3X5 m_waysCache;
 };  // namespace natasha
 
 }  // namespace natasha
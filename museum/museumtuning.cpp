@@ -0,0 +1,523 @@
+#include "museumtuning.h"
+#include <google/protobuf/util/json_util.h>
+#include <math.h>
+#include <fstream>
+#include <thread>
+#include "../include/fortuna.h"
+#include "../include/randomshards.h"
+
+namespace natasha {
+
+#ifdef NATASHA_SIMULATION
+// MuseumTuningStat - win of paid spins in totalbet
+struct MuseumTuningStat {
+  int64_t nums;
+  double sum;
+  double sumsq;
+
+  MuseumTuningStat() : nums(0), sum(0), sumsq(0) {}
+
+  void add(double win) {
+    nums++;
+    sum += win;
+    sumsq += win * win;
+  }
+
+  void merge(const MuseumTuningStat& stat) {
+    nums += stat.nums;
+    sum += stat.sum;
+    sumsq += stat.sumsq;
+  }
+
+  double getRTP() const { return nums > 0 ? sum / nums : 0; }
+
+  double getVolatility() const {
+    if (nums <= 1) {
+      return 0;
+    }
+
+    double mean = sum / nums;
+    double var = sumsq / nums - mean * mean;
+
+    return var > 0 ? sqrt(var) : 0;
+  }
+};
+
+// getTuningField - repeated field of param, NULL if param is invalid
+static ::google::protobuf::RepeatedField< ::google::protobuf::int32>*
+getTuningField(::natashapb::MuseumRTPConfig& rtpcfg,
+               const MuseumTuningParam& param) {
+  ::google::protobuf::RepeatedField< ::google::protobuf::int32>* pField =
+      NULL;
+
+  if (param.name == "bgmultipliers") {
+    pField = rtpcfg.mutable_bgmultipliers();
+  } else if (param.name == "fgmultipliers") {
+    pField = rtpcfg.mutable_fgmultipliers();
+  } else if (param.name == "bgbonusprize") {
+    pField = rtpcfg.mutable_bgbonusprize();
+  } else if (param.name == "fgbonusprize") {
+    pField = rtpcfg.mutable_fgbonusprize();
+  } else if (param.name == "bgmysterywild" ||
+             param.name == "fgmysterywild") {
+    auto pLst = param.name == "bgmysterywild" ? rtpcfg.mutable_bgmysterywild()
+                                              : rtpcfg.mutable_fgmysterywild();
+    if (param.index < 0 || param.index >= pLst->size()) {
+      return NULL;
+    }
+
+    auto pWeights = pLst->Mutable(param.index)->mutable_weights();
+    if (param.subindex < 0 || param.subindex >= pWeights->size()) {
+      return NULL;
+    }
+
+    return pWeights;
+  }
+
+  if (pField == NULL || param.index < 0 || param.index >= pField->size()) {
+    return NULL;
+  }
+
+  return pField;
+}
+
+// isValidTuningParam - is valid param
+static bool isValidTuningParam(::natashapb::MuseumRTPConfig& rtpcfg,
+                               const MuseumTuningParam& param) {
+  if (param.minValue > param.maxValue || param.step <= 0) {
+    return false;
+  }
+
+  if (param.name == "fgnums") {
+    return true;
+  }
+
+  return getTuningField(rtpcfg, param) != NULL;
+}
+
+// getTuningValue - get value of param
+static int getTuningValue(::natashapb::MuseumRTPConfig& rtpcfg,
+                          const MuseumTuningParam& param) {
+  if (param.name == "fgnums") {
+    return rtpcfg.fgnums();
+  }
+
+  auto pField = getTuningField(rtpcfg, param);
+  assert(pField != NULL);
+
+  if (param.name == "bgmysterywild" || param.name == "fgmysterywild") {
+    return pField->Get(param.subindex);
+  }
+
+  return pField->Get(param.index);
+}
+
+// setTuningValue - set value of param
+static void setTuningValue(::natashapb::MuseumRTPConfig& rtpcfg,
+                           const MuseumTuningParam& param, int value) {
+  if (param.name == "fgnums") {
+    rtpcfg.set_fgnums(value);
+
+    return;
+  }
+
+  auto pField = getTuningField(rtpcfg, param);
+  assert(pField != NULL);
+
+  if (param.name == "bgmysterywild" || param.name == "fgmysterywild") {
+    pField->Set(param.subindex, value);
+
+    auto pWeight = param.name == "bgmysterywild"
+                       ? rtpcfg.mutable_bgmysterywild(param.index)
+                       : rtpcfg.mutable_fgmysterywild(param.index);
+    pWeight->set_totalweight(sumWeightConfig(*pWeight));
+
+    return;
+  }
+
+  pField->Set(param.index, value);
+}
+
+// procSimMuseum - run spinNums paid spins with the thread random
+static ::natashapb::CODE procSimMuseum(Museum* pMuseum, const char* configName,
+                                       int64_t spinNums,
+                                       MuseumTuningStat* pStat) {
+
+  ::natashapb::UserGameLogicInfo ugi;
+  UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)pMuseum->getGameConfig(configName);
+
+  ugi.set_configname(configName);
+
+  auto code = pMuseum->userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::GameCtrl gamectrlBG;
+  auto spin = gamectrlBG.mutable_spin();
+  spin->set_bet(1);
+  spin->set_lines(MUSEUM_DEFAULT_PAY_LINES);
+  spin->set_times(MUSEUM_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl gamectrlFG;
+  auto freespin = gamectrlFG.mutable_freespin();
+  freespin->set_bet(1);
+  freespin->set_lines(MUSEUM_DEFAULT_PAY_LINES);
+  freespin->set_times(MUSEUM_DEFAULT_TIMES);
+
+  double totalbet = MUSEUM_DEFAULT_PAY_LINES;
+  double curwin = 0;
+  CtrlID ctrlid = 1;
+
+  while (pStat->nums < spinNums) {
+    auto curmod = pMuseum->getMainGameMod(&user, false);
+    auto pGameCtrl = curmod->getGameModType() == ::natashapb::BASE_GAME
+                         ? &gamectrlBG
+                         : &gamectrlFG;
+
+    pGameCtrl->set_ctrlid(ctrlid++);
+
+    code = pMuseum->gameCtrl(pGameCtrl, &user);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    auto pUGMI = pMuseum->getUserGameModInfo(&user, curmod->getGameModType());
+    curwin += pUGMI->spinresult().realwin();
+
+    if (ugi.iscompleted()) {
+      pStat->add(curwin / totalbet);
+
+      curwin = 0;
+    }
+  }
+
+  return ::natashapb::OK;
+}
+
+// evalMuseum - run rtpcfg in all threads
+//            - 候选用 recompileRTPConfig，不重建初始局面，不留旧的 config
+//            - 分成 shardNums 份，每份用 seed 的一个 stream，
+//              结果和线程数没有关系
+static ::natashapb::CODE evalMuseum(std::vector<Museum*>& lstMuseum,
+                                    const char* configName,
+                                    const ::natashapb::MuseumRTPConfig& rtpcfg,
+                                    int64_t spinNums, uint64_t seed,
+                                    int shardNums, MuseumTuningStat& stat) {
+  int threadNums = lstMuseum.size();
+
+  for (int i = 0; i < threadNums; ++i) {
+    auto code = lstMuseum[i]->recompileRTPConfig(configName, rtpcfg);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+  }
+
+  std::vector<MuseumTuningStat> lstStat(shardNums);
+  std::vector< ::natashapb::CODE> lstCode(shardNums, ::natashapb::OK);
+
+  runRandomShards(seed, shardNums, threadNums, [&](int shard, int thread) {
+    lstCode[shard] = procSimMuseum(lstMuseum[thread], configName,
+                                   getShardSize(spinNums, shardNums, shard),
+                                   &lstStat[shard]);
+  });
+
+  stat = MuseumTuningStat();
+  for (int i = 0; i < shardNums; ++i) {
+    stat.merge(lstStat[i]);
+  }
+
+  for (int i = 0; i < shardNums; ++i) {
+    if (lstCode[i] != ::natashapb::OK) {
+      return lstCode[i];
+    }
+  }
+
+  return ::natashapb::OK;
+}
+
+// isValidTuningTarget - tolerances are divisors of the score
+static bool isValidTuningTarget(const MuseumTuningTarget& target) {
+  if (target.rtpTolerance <= 0) {
+    return false;
+  }
+
+  if (target.volatility > 0 && target.volatilityTolerance <= 0) {
+    return false;
+  }
+
+  return true;
+}
+
+// getTuningScore - < 1 means all targets are in tolerance
+static double getTuningScore(const MuseumTuningTarget& target,
+                             const MuseumTuningStat& stat) {
+  double d = (stat.getRTP() - target.rtp) / target.rtpTolerance;
+  double score = d * d;
+
+  if (target.volatility > 0) {
+    d = (stat.getVolatility() - target.volatility) /
+        target.volatilityTolerance;
+    score += d * d;
+  }
+
+  return score;
+}
+
+// searchMuseumRTPConfig - pattern search from rtpcfg
+//   每一轮依次尝试每个参数 +step / -step，有改进就接受，
+//   一整轮都没有改进就把 step 减半，step 都是 1 时结束
+static ::natashapb::CODE searchMuseumRTPConfig(
+    std::vector<Museum*>& lstMuseum, const MuseumTuningConfig& cfg,
+    ::natashapb::MuseumRTPConfig& rtpcfg, MuseumTuningResult& result) {
+  std::vector<int> lstStep;
+  for (auto it = cfg.lstParam.begin(); it != cfg.lstParam.end(); ++it) {
+    lstStep.push_back(it->step);
+  }
+
+  MuseumTuningStat stat;
+  auto code = evalMuseum(lstMuseum, cfg.configName.c_str(), rtpcfg,
+                         cfg.spinNums, cfg.seed, cfg.shardNums, stat);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  double bestScore = getTuningScore(cfg.target, stat);
+
+  result.candidateNums = 1;
+  result.rounds = 0;
+
+  while (result.rounds < cfg.maxRounds && bestScore >= 1) {
+    ++result.rounds;
+
+    bool isImproved = false;
+
+    for (size_t i = 0; i < cfg.lstParam.size(); ++i) {
+      auto& param = cfg.lstParam[i];
+      int curvalue = getTuningValue(rtpcfg, param);
+
+      for (int dir = 1; dir >= -1; dir -= 2) {
+        int value = curvalue + dir * lstStep[i];
+        if (value < param.minValue) {
+          value = param.minValue;
+        } else if (value > param.maxValue) {
+          value = param.maxValue;
+        }
+
+        if (value == curvalue) {
+          continue;
+        }
+
+        ::natashapb::MuseumRTPConfig candidate;
+        candidate.CopyFrom(rtpcfg);
+        setTuningValue(candidate, param, value);
+
+        code = evalMuseum(lstMuseum, cfg.configName.c_str(), candidate,
+                          cfg.spinNums, cfg.seed, cfg.shardNums, stat);
+        if (code != ::natashapb::OK) {
+          return code;
+        }
+
+        ++result.candidateNums;
+
+        double score = getTuningScore(cfg.target, stat);
+        if (score < bestScore) {
+          bestScore = score;
+          rtpcfg.CopyFrom(candidate);
+          isImproved = true;
+
+          printf("tuning round %d %s[%d] = %d rtp %.4f%% volatility %.4f\n",
+                 result.rounds, param.name.c_str(), param.index, value,
+                 stat.getRTP() * 100, stat.getVolatility());
+
+          break;
+        }
+      }
+    }
+
+    if (!isImproved) {
+      bool isMinStep = true;
+      for (auto it = lstStep.begin(); it != lstStep.end(); ++it) {
+        if (*it > 1) {
+          *it = *it / 2;
+          isMinStep = false;
+        }
+      }
+
+      if (isMinStep) {
+        break;
+      }
+    }
+  }
+
+  // check with another seed
+  code = evalMuseum(lstMuseum, cfg.configName.c_str(), rtpcfg,
+                    cfg.finalSpinNums, cfg.seed + 0x9e3779b97f4a7c15ULL,
+                    cfg.shardNums, stat);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  result.rtp = stat.getRTP();
+  result.volatility = stat.getVolatility();
+  result.score = getTuningScore(cfg.target, stat);
+
+  return ::natashapb::OK;
+}
+
+// tuneMuseumRTPConfig - pattern search from cfg.configName
+::natashapb::CODE tuneMuseumRTPConfig(const char* cfgpath,
+                                      const MuseumTuningConfig& cfg,
+                                      ::natashapb::MuseumRTPConfig& rtpcfg,
+                                      MuseumTuningResult& result) {
+  assert(cfg.threadNums > 0);
+  assert(cfg.shardNums > 0);
+
+  if (!isValidTuningTarget(cfg.target)) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  std::vector<Museum*> lstMuseum;
+  ::natashapb::CODE code = ::natashapb::OK;
+
+  for (int i = 0; i < cfg.threadNums; ++i) {
+    auto pMuseum = new Museum();
+    lstMuseum.push_back(pMuseum);
+
+    // 初始局面是随机的，都用 cfg.seed 建，每个 Museum 都一样，
+    // 结果才和 threadNums 没有关系
+    setThreadRandomSeed(cfg.seed);
+    code = pMuseum->init(cfgpath);
+    clearThreadRandomSeed();
+
+    if (code != ::natashapb::OK) {
+      break;
+    }
+
+    if (pMuseum->getRTPConfig(cfg.configName.c_str()) == NULL) {
+      code = ::natashapb::INVALID_REELS_CFG;
+
+      break;
+    }
+  }
+
+  if (code == ::natashapb::OK) {
+    rtpcfg.CopyFrom(*lstMuseum[0]->getRTPConfig(cfg.configName.c_str()));
+
+    for (auto it = cfg.lstParam.begin(); it != cfg.lstParam.end(); ++it) {
+      if (!isValidTuningParam(rtpcfg, *it)) {
+        code = ::natashapb::INVALID_REELS_CFG;
+
+        break;
+      }
+    }
+  }
+
+  if (code == ::natashapb::OK) {
+    code = searchMuseumRTPConfig(lstMuseum, cfg, rtpcfg, result);
+  }
+
+  for (auto it = lstMuseum.begin(); it != lstMuseum.end(); ++it) {
+    delete *it;
+  }
+
+  return code;
+}
+
+// saveMuseumRTPConfig - save as json
+bool saveMuseumRTPConfig(const char* fn,
+                         const ::natashapb::MuseumRTPConfig& rtpcfg) {
+  std::string str;
+  ::google::protobuf::util::JsonPrintOptions options;
+  options.add_whitespace = true;
+
+  auto status =
+      ::google::protobuf::util::MessageToJsonString(rtpcfg, &str, options);
+  if (!status.ok()) {
+    return false;
+  }
+
+  std::ofstream f(fn);
+  if (!f.is_open()) {
+    return false;
+  }
+
+  f << str;
+
+  return f.good();
+}
+
+// tuneRTP_museum - tune rtp96
+void tuneRTP_museum() {
+  MuseumTuningConfig cfg;
+
+  cfg.configName = "rtp96";
+  cfg.target.rtp = 0.96;
+  cfg.target.rtpTolerance = 0.002;
+  cfg.target.volatility = 0;
+  cfg.target.volatilityTolerance = 1;
+  cfg.threadNums = std::thread::hardware_concurrency();
+  if (cfg.threadNums <= 0) {
+    cfg.threadNums = 1;
+  }
+
+  cfg.shardNums = 64;
+  cfg.spinNums = 1000000;
+  cfg.finalSpinNums = 10000000;
+  cfg.maxRounds = 100;
+  cfg.seed = 20180808;
+
+  for (int i = 0; i < 6; ++i) {
+    MuseumTuningParam param;
+
+    param.name = "bgbonusprize";
+    param.index = i;
+    param.subindex = 0;
+    param.minValue = 1;
+    param.maxValue = 100;
+    param.step = 4;
+
+    cfg.lstParam.push_back(param);
+  }
+
+  MuseumTuningParam param;
+
+  param.name = "fgnums";
+  param.index = 0;
+  param.subindex = 0;
+  param.minValue = 8;
+  param.maxValue = 20;
+  param.step = 2;
+
+  cfg.lstParam.push_back(param);
+
+  printf("%ld\n", time(NULL));
+
+  ::natashapb::MuseumRTPConfig rtpcfg;
+  MuseumTuningResult result;
+
+  auto c = tuneMuseumRTPConfig("./csv", cfg, rtpcfg, result);
+  if (c != ::natashapb::OK) {
+    printf("tuneMuseumRTPConfig fail(%d)!\n", c);
+
+    return;
+  }
+
+  printf("rounds %d candidates %d rtp %.4f%% volatility %.4f score %.4f\n",
+         result.rounds, result.candidateNums, result.rtp * 100,
+         result.volatility, result.score);
+
+  if (!saveMuseumRTPConfig("./museum_rtp96.json", rtpcfg)) {
+    printf("saveMuseumRTPConfig fail!\n");
+  }
+
+  printf("%ld\n", time(NULL));
+
+  printf("end!\n");
+}
+
+#endif  // NATASHA_SIMULATION
+
+}  // namespace natasha
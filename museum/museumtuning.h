@@ -0,0 +1,86 @@
+#ifndef __NATASHA_MUSEUMTUNING_H__
+#define __NATASHA_MUSEUMTUNING_H__
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include "museum.h"
+
+namespace natasha {
+
+#ifdef NATASHA_SIMULATION
+// tuning 用 setThreadRandomSeed，只在定义了 NATASHA_SIMULATION 时才有
+
+// MuseumTuningParam - range of one parameter in MuseumRTPConfig
+//   name - fgnums, bgmultipliers, fgmultipliers, bgbonusprize, fgbonusprize,
+//          bgmysterywild, fgmysterywild
+//   index - index in repeated field
+//   subindex - index in weights, only for mysterywild
+struct MuseumTuningParam {
+  std::string name;
+  int index;
+  int subindex;
+  int minValue;
+  int maxValue;
+  int step;
+};
+
+// MuseumTuningTarget - volatility is the standard deviation of the win of
+//                      a paid spin (with free game) in totalbet,
+//                      volatility <= 0 means no target
+//                    - 两个 tolerance 是除数，rtpTolerance 必须大于 0，
+//                      有 volatility 目标时 volatilityTolerance 也必须大于 0，
+//                      否则 tuneMuseumRTPConfig 返回 INVALID_REELS_CFG
+struct MuseumTuningTarget {
+  double rtp;
+  double rtpTolerance;
+  double volatility;
+  double volatilityTolerance;
+};
+
+// MuseumTuningConfig - tuning config
+//   所有候选参数都用同样的 seed（common random numbers），
+//   这样候选之间的差异不会被随机噪声淹没
+struct MuseumTuningConfig {
+  std::string configName;
+  std::vector<MuseumTuningParam> lstParam;
+  MuseumTuningTarget target;
+  int threadNums;
+  // shardNums - spins are split into shardNums random streams, the result
+  //             only depends on seed and shardNums, not threadNums
+  int shardNums;
+  // spinNums - paid spins for each candidate
+  int64_t spinNums;
+  // finalSpinNums - paid spins to check the result, with another seed
+  int64_t finalSpinNums;
+  int maxRounds;
+  uint64_t seed;
+};
+
+// MuseumTuningResult - result
+struct MuseumTuningResult {
+  double rtp;
+  double volatility;
+  double score;
+  int rounds;
+  int candidateNums;
+};
+
+// tuneMuseumRTPConfig - pattern search from cfg.configName
+::natashapb::CODE tuneMuseumRTPConfig(const char* cfgpath,
+                                      const MuseumTuningConfig& cfg,
+                                      ::natashapb::MuseumRTPConfig& rtpcfg,
+                                      MuseumTuningResult& result);
+
+// saveMuseumRTPConfig - save as json
+bool saveMuseumRTPConfig(const char* fn,
+                         const ::natashapb::MuseumRTPConfig& rtpcfg);
+
+// tuneRTP_museum - tune rtp96
+void tuneRTP_museum();
+
+#endif  // NATASHA_SIMULATION
+
+}  // namespace natasha
+
+#endif  // __NATASHA_MUSEUMTUNING_H__
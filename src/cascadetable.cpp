@@ -0,0 +1,376 @@
+#include "../include/cascadetable.h"
+#include <stdio.h>
+
+namespace natasha {
+
+void CascadeTable::clear() {
+  m_mapStep.clear();
+  m_spinNums = 0;
+}
+
+// addStep - add a cascade step
+void CascadeTable::addStep(::natashapb::GAMEMODTYPE module, int key,
+                           int nextKey, int fgnums, double win, double realwin,
+                           double bonus) {
+  assert(key >= 0 && key < CASCADE_MAX_KEYNUMS);
+  assert(nextKey >= -1 && nextKey < CASCADE_MAX_KEYNUMS);
+  assert(fgnums >= 0);
+
+  auto& lst = m_mapStep[module];
+  if (key >= (int)lst.size()) {
+    lst.resize(key + 1);
+  }
+
+  auto& step = lst[key];
+
+  step.nums++;
+  step.win += win;
+  step.realwin += realwin;
+  step.bonus += bonus;
+  step.mapTransition[std::make_pair(nextKey, fgnums)]++;
+}
+
+// merge - merge other table
+void CascadeTable::merge(const CascadeTable& table) {
+  for (auto it = table.m_mapStep.begin(); it != table.m_mapStep.end(); ++it) {
+    auto& lst = m_mapStep[it->first];
+    if (it->second.size() > lst.size()) {
+      lst.resize(it->second.size());
+    }
+
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      auto& src = it->second[i];
+      auto& dest = lst[i];
+
+      dest.nums += src.nums;
+      dest.win += src.win;
+      dest.realwin += src.realwin;
+      dest.bonus += src.bonus;
+
+      for (auto tit = src.mapTransition.begin(); tit != src.mapTransition.end();
+           ++tit) {
+        dest.mapTransition[tit->first] += tit->second;
+      }
+    }
+  }
+
+  m_spinNums += table.m_spinNums;
+}
+
+// getStep - get step, NULL if not found
+const CascadeStep* CascadeTable::getStep(::natashapb::GAMEMODTYPE module,
+                                         int key) const {
+  auto it = m_mapStep.find(module);
+  if (it == m_mapStep.end()) {
+    return NULL;
+  }
+
+  if (key < 0 || key >= (int)it->second.size()) {
+    return NULL;
+  }
+
+  return &(it->second[key]);
+}
+
+// getKeyNums - max key + 1
+int CascadeTable::getKeyNums(::natashapb::GAMEMODTYPE module) const {
+  auto it = m_mapStep.find(module);
+  if (it == m_mapStep.end()) {
+    return 0;
+  }
+
+  return it->second.size();
+}
+
+// getTotalRealWin - sum of realwin in all steps
+double CascadeTable::getTotalRealWin() const {
+  double totalwin = 0;
+
+  for (auto it = m_mapStep.begin(); it != m_mapStep.end(); ++it) {
+    for (auto sit = it->second.begin(); sit != it->second.end(); ++sit) {
+      totalwin += sit->realwin;
+    }
+  }
+
+  return totalwin;
+}
+
+// sampleCascadeTable - run gameCtrl until spinNums paid spins are completed
+//                    - 用真实的游戏逻辑采样，记录每一次 cascade
+::natashapb::CODE sampleCascadeTable(GameLogic& logic, UserInfo* pUser,
+                                     ::natashapb::GameCtrl* pGameCtrlBG,
+                                     ::natashapb::GameCtrl* pGameCtrlFG,
+                                     int64_t spinNums, FuncCascadeKey funcKey,
+                                     CascadeTable& table) {
+  assert(pUser != NULL);
+  assert(pUser->pLogicUser != NULL);
+  assert(pGameCtrlBG != NULL);
+  assert(pGameCtrlFG != NULL);
+
+  int64_t curspinnums = 0;
+  CtrlID ctrlid = 1;
+
+  while (curspinnums < spinNums || !pUser->pLogicUser->iscompleted()) {
+    auto curmod = logic.getMainGameMod(pUser, false);
+    assert(curmod != NULL);
+
+    auto module = curmod->getGameModType();
+    auto pUGMI = logic.getUserGameModInfo(pUser, module);
+    assert(pUGMI != NULL);
+
+    auto pGameCtrl =
+        module == ::natashapb::BASE_GAME ? pGameCtrlBG : pGameCtrlFG;
+
+    int key = 0;
+    if (!pUGMI->cascadinginfo().isend()) {
+      key = funcKey(module, pUGMI);
+    } else if (module == ::natashapb::BASE_GAME) {
+      ++curspinnums;
+    }
+
+    pGameCtrl->set_ctrlid(ctrlid++);
+
+    auto code = logic.gameCtrl(pGameCtrl, pUser);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    int nextKey = -1;
+    if (!pUGMI->cascadinginfo().isend()) {
+      nextKey = funcKey(module, pUGMI);
+    }
+
+    double totalbet = 0;
+    if (module == ::natashapb::BASE_GAME) {
+      totalbet = pGameCtrl->spin().bet() * pGameCtrl->spin().lines();
+    } else {
+      totalbet = pGameCtrl->freespin().bet() * pGameCtrl->freespin().lines();
+    }
+
+    assert(totalbet > 0);
+
+    auto& spinret = pUGMI->spinresult();
+
+    double bonus = 0;
+    for (int i = 0; i < spinret.lstgri_size(); ++i) {
+      auto& gri = spinret.lstgri(i);
+      if (gri.typegameresult() == ::natashapb::SPECIAL && gri.mul() > 0) {
+        bonus += (double)gri.realwin() / gri.mul();
+      }
+    }
+
+    table.addStep(module, key, nextKey, spinret.fgnums(),
+                  spinret.win() / totalbet, spinret.realwin() / totalbet,
+                  bonus / totalbet);
+  }
+
+  table.addSpinNums(curspinnums);
+
+  return ::natashapb::OK;
+}
+
+// getCascadeMeanRealWin - default FuncCascadeReward
+double getCascadeMeanRealWin(::natashapb::GAMEMODTYPE module, int key,
+                             const CascadeStep& step) {
+  return step.getMeanRealWin();
+}
+
+// FuncFGValue - value of starting FG with spins
+typedef std::function<double(int spins)> FuncFGValue;
+
+// buildFGChain - state (key, remaining spins)
+//              - 一次 cascade 开始时消耗 1 次，fgnums 是 retrigger
+static void buildFGChain(MarkovChain& chain, const CascadeTable& table,
+                         const CascadeModel& model,
+                         FuncCascadeReward funcReward, bool isSpinNums) {
+  int keynums = table.getKeyNums(::natashapb::FREE_GAME);
+  int maxnums = model.maxFreeNums;
+
+  chain.init(keynums * (maxnums + 1));
+
+  for (int n = 0; n <= maxnums; ++n) {
+    for (int key = 0; key < keynums; ++key) {
+      auto pStep = table.getStep(::natashapb::FREE_GAME, key);
+      if (pStep == NULL || pStep->nums <= 0) {
+        continue;
+      }
+
+      int state = n * keynums + key;
+
+      if (isSpinNums) {
+        chain.setReward(state, key == 0 ? 1 : 0);
+      } else {
+        chain.setReward(state,
+                        funcReward(::natashapb::FREE_GAME, key, *pStep));
+      }
+
+      for (auto it = pStep->mapTransition.begin();
+           it != pStep->mapTransition.end(); ++it) {
+        double p = (double)it->second / pStep->nums;
+        int nextKey = it->first.first;
+        int lastnums = n + it->first.second;
+        if (lastnums > maxnums) {
+          lastnums = maxnums;
+        }
+
+        if (nextKey >= 0) {
+          chain.addTransition(state, lastnums * keynums + nextKey, p);
+        } else if (lastnums > 0) {
+          chain.addTransition(state, (lastnums - 1) * keynums, p);
+        }
+      }
+    }
+  }
+}
+
+// buildBGChain - state (key, fgcache)
+static void buildBGChain(MarkovChain& chain, const CascadeTable& table,
+                         const CascadeModel& model,
+                         FuncCascadeReward funcReward, FuncFGValue funcFG,
+                         bool hasWin) {
+  int keynums = table.getKeyNums(::natashapb::BASE_GAME);
+  int maxcache = model.isFGImmediately ? 0 : model.maxFGCache;
+
+  chain.init(keynums * (maxcache + 1));
+
+  for (int c = 0; c <= maxcache; ++c) {
+    for (int key = 0; key < keynums; ++key) {
+      auto pStep = table.getStep(::natashapb::BASE_GAME, key);
+      if (pStep == NULL || pStep->nums <= 0) {
+        continue;
+      }
+
+      int state = c * keynums + key;
+
+      if (hasWin) {
+        chain.setReward(state,
+                        funcReward(::natashapb::BASE_GAME, key, *pStep));
+      }
+
+      for (auto it = pStep->mapTransition.begin();
+           it != pStep->mapTransition.end(); ++it) {
+        double p = (double)it->second / pStep->nums;
+        int nextKey = it->first.first;
+        int fgnums = it->first.second;
+
+        if (model.isFGImmediately) {
+          if (fgnums > 0) {
+            chain.addReward(state, p * funcFG(fgnums));
+          }
+
+          if (nextKey >= 0) {
+            chain.addTransition(state, nextKey, p);
+          }
+
+          continue;
+        }
+
+        int cache = c + fgnums;
+        if (cache > maxcache) {
+          cache = maxcache;
+        }
+
+        if (nextKey >= 0) {
+          chain.addTransition(state, cache * keynums + nextKey, p);
+        } else if (cache > 0) {
+          chain.addReward(state, p * funcFG(cache));
+        }
+      }
+    }
+  }
+}
+
+// solveCascadeRTP - solve BG / FG markov chain
+//                 - 修改 multipliers 这类不影响盘面的参数时，只需要换 funcReward
+bool solveCascadeRTP(const CascadeTable& table, const CascadeModel& model,
+                     FuncCascadeReward funcReward, CascadeRTPResult& result) {
+  result.bgRTP = 0;
+  result.fgRTP = 0;
+  result.totalRTP = 0;
+  result.fgTriggerNums = 0;
+  result.fgSpinNums = 0;
+
+  if (table.getStep(::natashapb::BASE_GAME, 0) == NULL) {
+    return false;
+  }
+
+  std::vector<double> lstFGWin;
+  std::vector<double> lstFGSpinNums;
+
+  if (table.getKeyNums(::natashapb::FREE_GAME) > 0) {
+    MarkovChain fgchain;
+
+    buildFGChain(fgchain, table, model, funcReward, false);
+    if (!fgchain.solve(lstFGWin)) {
+      return false;
+    }
+
+    buildFGChain(fgchain, table, model, funcReward, true);
+    if (!fgchain.solve(lstFGSpinNums)) {
+      return false;
+    }
+  }
+
+  int fgkeynums = table.getKeyNums(::natashapb::FREE_GAME);
+  auto getFGValue = [&](const std::vector<double>& lst, int spins) {
+    if (spins <= 0 || lst.empty()) {
+      return 0.0;
+    }
+
+    if (spins > model.maxFreeNums) {
+      spins = model.maxFreeNums;
+    }
+
+    return lst[(spins - 1) * fgkeynums];
+  };
+
+  MarkovChain bgchain;
+  std::vector<double> lstValue;
+
+  buildBGChain(bgchain, table, model, funcReward,
+               [](int spins) { return 0.0; }, true);
+  if (!bgchain.solve(lstValue)) {
+    return false;
+  }
+
+  result.bgRTP = lstValue[0];
+
+  buildBGChain(bgchain, table, model, funcReward,
+               [&](int spins) { return getFGValue(lstFGWin, spins); }, false);
+  if (!bgchain.solve(lstValue)) {
+    return false;
+  }
+
+  result.fgRTP = lstValue[0];
+  result.totalRTP = result.bgRTP + result.fgRTP;
+
+  buildBGChain(bgchain, table, model, funcReward,
+               [&](int spins) { return getFGValue(lstFGSpinNums, spins); },
+               false);
+  if (!bgchain.solve(lstValue)) {
+    return false;
+  }
+
+  result.fgSpinNums = lstValue[0];
+
+  buildBGChain(bgchain, table, model, funcReward,
+               [](int spins) { return 1.0; }, false);
+  if (!bgchain.solve(lstValue)) {
+    return false;
+  }
+
+  result.fgTriggerNums = lstValue[0];
+
+  return true;
+}
+
+// outputCascadeRTPResult - print result
+void outputCascadeRTPResult(const char* name, const CascadeRTPResult& result) {
+  printf("%s markov rtp is %.4f%%\n", name, result.totalRTP * 100);
+  printf("bg rtp is %.4f%%\n", result.bgRTP * 100);
+  printf("fg rtp is %.4f%%\n", result.fgRTP * 100);
+  printf("fg trigger is %.6f\n", result.fgTriggerNums);
+  printf("fg spins is %.6f\n", result.fgSpinNums);
+}
+
+}  // namespace natasha
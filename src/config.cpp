@@ -1,4 +1,5 @@
 #include "../include/config.h"
+#include <limits.h>
 #include "../include/fortuna.h"
 
 namespace natasha {
@@ -16,7 +17,7 @@ int sumWeightConfig(const ::natashapb::WeightConfig& cfg) {
 int randWeightConfig(const ::natashapb::WeightConfig& cfg) {
   auto cr = randomScale(cfg.totalweight());
   for (int i = 0; i < cfg.weights_size(); ++i) {
-    if (cr < cfg.weights(i)) {
+    if (cr < (uint32_t)cfg.weights(i)) {
       return i;
     }
 
@@ -26,4 +27,151 @@ int randWeightConfig(const ::natashapb::WeightConfig& cfg) {
   return -1;
 }
 
-}  // namespace natasha
\ No newline at end of file
+// isValidWeightConfig - not empty, no negative weight, and totalweight is the
+//                       sum of weights (> 0)
+//                     - totalweight 是 0 时 randomScale 会除 0
+bool isValidWeightConfig(const ::natashapb::WeightConfig& cfg) {
+  if (cfg.weights_size() <= 0 || cfg.totalweight() <= 0) {
+    return false;
+  }
+
+  for (int i = 0; i < cfg.weights_size(); ++i) {
+    if (cfg.weights(i) < 0) {
+      return false;
+    }
+  }
+
+  return sumWeightConfig(cfg) == cfg.totalweight();
+}
+
+// compileWeightConfig - WeightConfig -> WeightTable
+void compileWeightConfig(const ::natashapb::WeightConfig& cfg,
+                         WeightTable& table) {
+  table.lstWeight.assign(cfg.weights().begin(), cfg.weights().end());
+  table.totalWeight = cfg.totalweight();
+}
+
+// randWeightTable - same random draws as randWeightConfig
+int randWeightTable(const WeightTable& table) {
+  assert(table.totalWeight > 0);
+
+  auto cr = randomScale(table.totalWeight);
+  for (size_t i = 0; i < table.lstWeight.size(); ++i) {
+    if (cr < (uint32_t)table.lstWeight[i]) {
+      return i;
+    }
+
+    cr -= table.lstWeight[i];
+  }
+
+  return -1;
+}
+
+// buildAliasTable - weights -> AliasTable, false if empty, negative or the
+//                   total is 0 or too big
+//                 - 每个 weight 乘 n，这样每格正好是 totalWeight，不需要浮点数
+bool buildAliasTable(const std::vector<int>& lstWeight, AliasTable& table) {
+  table.lstProb.clear();
+  table.lstAlias.clear();
+  table.totalWeight = 0;
+
+  int n = lstWeight.size();
+  int64_t total = 0;
+
+  for (int i = 0; i < n; ++i) {
+    if (lstWeight[i] < 0) {
+      return false;
+    }
+
+    total += lstWeight[i];
+  }
+
+  if (n <= 0 || total <= 0 || total > INT_MAX) {
+    return false;
+  }
+
+  std::vector<int64_t> lstScaled(n);
+  std::vector<int> lstSmall, lstLarge;
+
+  for (int i = 0; i < n; ++i) {
+    lstScaled[i] = (int64_t)lstWeight[i] * n;
+
+    if (lstScaled[i] < total) {
+      lstSmall.push_back(i);
+    } else {
+      lstLarge.push_back(i);
+    }
+  }
+
+  table.lstProb.assign(n, (int)total);
+  table.lstAlias.resize(n);
+  for (int i = 0; i < n; ++i) {
+    table.lstAlias[i] = i;
+  }
+
+  while (!lstSmall.empty() && !lstLarge.empty()) {
+    int s = lstSmall.back();
+    lstSmall.pop_back();
+    int l = lstLarge.back();
+    lstLarge.pop_back();
+
+    table.lstProb[s] = lstScaled[s];
+    table.lstAlias[s] = l;
+
+    lstScaled[l] -= total - lstScaled[s];
+    if (lstScaled[l] < total) {
+      lstSmall.push_back(l);
+    } else {
+      lstLarge.push_back(l);
+    }
+  }
+
+  // 整数没有误差，剩下的都正好是一格
+  assert(lstSmall.empty());
+
+  table.totalWeight = total;
+
+  return true;
+}
+
+// compileAliasTable - WeightConfig -> AliasTable, false if not
+//                     isValidWeightConfig
+bool compileAliasTable(const ::natashapb::WeightConfig& cfg,
+                       AliasTable& table) {
+  if (!isValidWeightConfig(cfg)) {
+    return false;
+  }
+
+  std::vector<int> lstWeight(cfg.weights().begin(), cfg.weights().end());
+
+  return buildAliasTable(lstWeight, table);
+}
+
+// randAliasTable - return [0, weights), one randomScale if weights *
+//                  totalWeight fits in uint32_t
+//                - 一个随机数拆成格子和格子里的位置，分布和两个随机数一样
+int randAliasTable(const AliasTable& table) {
+  assert(table.totalWeight > 0);
+
+  uint64_t range = (uint64_t)table.lstProb.size() * table.totalWeight;
+  int i;
+  uint32_t cr;
+
+  if (range <= UINT32_MAX) {
+    uint32_t r = randomScale(range);
+
+    i = r / table.totalWeight;
+    cr = r % table.totalWeight;
+  } else {
+    i = randomScale(table.lstProb.size());
+    cr = randomScale(table.totalWeight);
+  }
+
+  if (cr < (uint32_t)table.lstProb[i]) {
+    return i;
+  }
+
+  return table.lstAlias[i];
+}
+
+}  // namespace natasha
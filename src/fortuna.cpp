@@ -1,26 +1,438 @@
 #include "../include/fortuna.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "../libfortuna/fortuna.h"
+#ifdef NATASHA_SIMULATION
+#include "../include/xoshiro256.h"
+#endif  // NATASHA_SIMULATION
 
 namespace natasha {
 
-// random - return uint32 number
-uint32_t random() {
+#ifdef NATASHA_SIMULATION
+// thread random - fortuna is not thread safe, simulation threads use their
+// own xoshiro256**
+//   - 正式服务器不定义 NATASHA_SIMULATION，只会用 fortuna
+static thread_local bool s_isThreadRandom = false;
+static thread_local Xoshiro256 s_threadRandom;
+
+// s_pThreadReplay - replay of current thread, see setThreadRandomReplay
+static thread_local RandomReplay* s_pThreadReplay = NULL;
+#endif  // NATASHA_SIMULATION
+
+// s_pThreadJournal - journal of current thread, see setThreadRandomJournal
+static thread_local RandomJournal* s_pThreadJournal = NULL;
+
+// s_fortunaLock - fortuna is shared with the entropy thread
+//               - 没有 entropy 线程时没有竞争，加锁只是一次原子操作
+static std::mutex s_fortunaLock;
+
+// ENTROPY_BYTES - bytes from the system for each harvest
+const int ENTROPY_BYTES = 32;
+
+static std::mutex s_entropyThreadLock;
+static std::condition_variable s_entropyCond;
+static std::thread s_entropyThread;
+static bool s_isEntropyRunning = false;
+static bool s_isEntropyStop = false;
+
+static std::atomic<int64_t> s_harvestNums(0);
+static std::atomic<int64_t> s_harvestBytes(0);
+static std::atomic<int64_t> s_reseedNums(0);
+static std::atomic<int64_t> s_maxReseedTime(0);
+static std::atomic<int64_t> s_lastReseedTime(0);
+
+static inline uint32_t getRandom32() {
+#ifdef NATASHA_SIMULATION
+  if (s_isThreadRandom) {
+    return (uint32_t)(s_threadRandom.next() >> 32);
+  }
+#endif  // NATASHA_SIMULATION
+
   uint32_t cr = 0;
+  std::lock_guard<std::mutex> lock(s_fortunaLock);
   fortuna_get_bytes(4, (uint8_t*)&cr);
   return cr;
 }
 
+#ifdef NATASHA_SIMULATION
+// replayRandomList - pOut[i] from s_pThreadReplay, range is pMax[i], or max if
+//                    pMax is NULL
+static void replayRandomList(uint32_t* pOut, const uint32_t* pMax,
+                             uint32_t max, int nums) {
+  for (int i = 0; i < nums; ++i) {
+    s_pThreadReplay->pop(pMax != NULL ? pMax[i] : max, pOut[i]);
+  }
+}
+#endif  // NATASHA_SIMULATION
+
+// journalRandomList - add pOut[i] to s_pThreadJournal, range is pMax[i], or
+//                     max if pMax is NULL
+static void journalRandomList(const uint32_t* pOut, const uint32_t* pMax,
+                              uint32_t max, int nums) {
+  for (int i = 0; i < nums; ++i) {
+    s_pThreadJournal->push(pMax != NULL ? pMax[i] : max, pOut[i]);
+  }
+}
+
+// random - return uint32 number
+uint32_t random() {
+#ifdef NATASHA_SIMULATION
+  if (s_pThreadReplay != NULL) {
+    uint32_t cr = 0;
+    s_pThreadReplay->pop(RANDOMJOURNAL_FULLRANGE, cr);
+    return cr;
+  }
+#endif  // NATASHA_SIMULATION
+
+  uint32_t cr = getRandom32();
+
+  if (s_pThreadJournal != NULL) {
+    s_pThreadJournal->push(RANDOMJOURNAL_FULLRANGE, cr);
+  }
+
+  return cr;
+}
+
+// scaleRandom - cr * max / 2^32, false if cr must be rejected
+//             - Lemire 的乘法缩放，只有低 32 位 < max 时才要算一次取模，
+//               被拒绝的概率是 (2^32 % max) / 2^32
+static inline bool scaleRandom(uint32_t cr, uint32_t max, uint32_t& out) {
+  assert(max > 0);
+
+  uint64_t m = (uint64_t)cr * max;
+  uint32_t l = (uint32_t)m;
+
+  if (l < max) {
+    // 2^32 % max
+    uint32_t t = (0u - max) % max;
+    if (l < t) {
+      return false;
+    }
+  }
+
+  out = m >> 32;
+
+  return true;
+}
+
 // randomScale - return [0, max)
 uint32_t randomScale(uint32_t max) {
   uint32_t cr = 0;
-  uint64_t MAX_RANGE = ((uint64_t)1) << 32;
-  uint64_t limit = MAX_RANGE - (MAX_RANGE % max);
 
-  do {
-    fortuna_get_bytes(4, (uint8*)&cr);
-  } while (cr >= limit);
+#ifdef NATASHA_SIMULATION
+  if (s_pThreadReplay != NULL) {
+    s_pThreadReplay->pop(max, cr);
+    return cr;
+  }
+#endif  // NATASHA_SIMULATION
+
+  while (!scaleRandom(getRandom32(), max, cr)) {
+  }
+
+  if (s_pThreadJournal != NULL) {
+    s_pThreadJournal->push(max, cr);
+  }
+
+  return cr;
+}
+
+// fillRandom32 - fill nums uint32 numbers in one request, without the
+//                journal
+static void fillRandom32(uint32_t* pOut, int nums) {
+#ifdef NATASHA_SIMULATION
+  if (s_isThreadRandom) {
+    for (int i = 0; i < nums; ++i) {
+      pOut[i] = (uint32_t)(s_threadRandom.next() >> 32);
+    }
+
+    return;
+  }
+#endif  // NATASHA_SIMULATION
+
+  std::lock_guard<std::mutex> lock(s_fortunaLock);
+  fortuna_get_bytes(nums * sizeof(uint32_t), (uint8_t*)pOut);
+}
+
+// randomArray - fill nums uint32 numbers in one request
+void randomArray(uint32_t* pOut, int nums) {
+  assert(pOut != NULL);
+
+  if (nums <= 0) {
+    return;
+  }
+
+#ifdef NATASHA_SIMULATION
+  if (s_pThreadReplay != NULL) {
+    replayRandomList(pOut, NULL, RANDOMJOURNAL_FULLRANGE, nums);
+    return;
+  }
+#endif  // NATASHA_SIMULATION
+
+  fillRandom32(pOut, nums);
+
+  if (s_pThreadJournal != NULL) {
+    journalRandomList(pOut, NULL, RANDOMJOURNAL_FULLRANGE, nums);
+  }
+}
+
+// randomScaleArray - fill nums numbers in [0, max) with one randomArray
+void randomScaleArray(uint32_t* pOut, int nums, uint32_t max) {
+  assert(pOut != NULL);
+
+  if (nums <= 0) {
+    return;
+  }
+
+#ifdef NATASHA_SIMULATION
+  if (s_pThreadReplay != NULL) {
+    replayRandomList(pOut, NULL, max, nums);
+    return;
+  }
+#endif  // NATASHA_SIMULATION
+
+  fillRandom32(pOut, nums);
+
+  for (int i = 0; i < nums; ++i) {
+    while (!scaleRandom(pOut[i], max, pOut[i])) {
+      pOut[i] = getRandom32();
+    }
+  }
+
+  if (s_pThreadJournal != NULL) {
+    journalRandomList(pOut, NULL, max, nums);
+  }
+}
+
+// randomScaleList - fill pOut[i] in [0, pMax[i]) with one randomArray
+void randomScaleList(uint32_t* pOut, const uint32_t* pMax, int nums) {
+  assert(pOut != NULL);
+  assert(pMax != NULL);
+
+  if (nums <= 0) {
+    return;
+  }
+
+#ifdef NATASHA_SIMULATION
+  if (s_pThreadReplay != NULL) {
+    replayRandomList(pOut, pMax, 0, nums);
+    return;
+  }
+#endif  // NATASHA_SIMULATION
+
+  fillRandom32(pOut, nums);
+
+  for (int i = 0; i < nums; ++i) {
+    while (!scaleRandom(pOut[i], pMax[i], pOut[i])) {
+      pOut[i] = getRandom32();
+    }
+  }
+
+  if (s_pThreadJournal != NULL) {
+    journalRandomList(pOut, pMax, 0, nums);
+  }
+}
+
+// setThreadRandomJournal - record the draws of current thread in pJournal
+RandomJournal* setThreadRandomJournal(RandomJournal* pJournal) {
+  auto pLast = s_pThreadJournal;
+  s_pThreadJournal = pJournal;
+
+  return pLast;
+}
+
+// harvestSystemEntropy - read len bytes from the system, return the bytes read
+static int harvestSystemEntropy(uint8_t* pBuf, int len) {
+  int fd = open("/dev/urandom", O_RDONLY);
+  if (fd == -1) {
+    return 0;
+  }
 
-  return cr % max;
+  int nums = 0;
+  while (nums < len) {
+    auto cr = read(fd, pBuf + nums, len - nums);
+    if (cr <= 0) {
+      break;
+    }
+
+    nums += cr;
+  }
+
+  close(fd);
+
+  return nums;
 }
 
-}  // namespace natasha
\ No newline at end of file
+// feedEntropy - harvest system entropy, add it to fortuna and reseed
+//             - 读系统熵时不加锁，锁里只有 add_entropy 和 reseed
+static void feedEntropy() {
+  uint8_t buf[ENTROPY_BYTES];
+  int nums = harvestSystemEntropy(buf, ENTROPY_BYTES);
+
+  if (nums > 0) {
+    ++s_harvestNums;
+    s_harvestBytes += nums;
+  }
+
+  auto st = std::chrono::steady_clock::now();
+  int reseeded = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(s_fortunaLock);
+
+    if (nums > 0) {
+      fortuna_add_entropy(buf, nums);
+    }
+
+    reseeded = fortuna_reseed();
+  }
+
+  auto et = std::chrono::steady_clock::now();
+
+  memset(buf, 0, sizeof(buf));
+
+  if (reseeded) {
+    int64_t t =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(et - st).count();
+
+    ++s_reseedNums;
+    if (t > s_maxReseedTime) {
+      s_maxReseedTime = t;
+    }
+
+    s_lastReseedTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           et.time_since_epoch())
+                           .count();
+  }
+}
+
+static void procEntropyThread(int intervalms) {
+  std::unique_lock<std::mutex> lock(s_entropyThreadLock);
+
+  while (!s_isEntropyStop) {
+    s_entropyCond.wait_for(lock, std::chrono::milliseconds(intervalms),
+                           [] { return s_isEntropyStop; });
+
+    if (s_isEntropyStop) {
+      break;
+    }
+
+    lock.unlock();
+    feedEntropy();
+    lock.lock();
+  }
+}
+
+// startEntropyThread - harvest system entropy and reseed fortuna every
+//                      intervalms in a thread, false if already started
+bool startEntropyThread(int intervalms) {
+  assert(intervalms > 0);
+
+  std::lock_guard<std::mutex> lock(s_entropyThreadLock);
+
+  if (s_isEntropyRunning) {
+    return false;
+  }
+
+  // 第一次在调用者的线程里，返回以后取的随机数都是播过种的
+  feedEntropy();
+
+  {
+    std::lock_guard<std::mutex> lockFortuna(s_fortunaLock);
+    fortuna_set_auto_reseed(0);
+  }
+
+  s_isEntropyStop = false;
+  s_isEntropyRunning = true;
+  s_entropyThread = std::thread(procEntropyThread, intervalms);
+
+  return true;
+}
+
+// stopEntropyThread - stop the entropy thread, fortuna reseeds in
+//                     fortuna_get_bytes again
+void stopEntropyThread() {
+  {
+    std::lock_guard<std::mutex> lock(s_entropyThreadLock);
+
+    if (!s_isEntropyRunning) {
+      return;
+    }
+
+    s_isEntropyStop = true;
+  }
+
+  s_entropyCond.notify_all();
+  s_entropyThread.join();
+
+  std::lock_guard<std::mutex> lock(s_entropyThreadLock);
+  s_isEntropyRunning = false;
+
+  std::lock_guard<std::mutex> lockFortuna(s_fortunaLock);
+  fortuna_set_auto_reseed(1);
+}
+
+// isEntropyThreadRunning - is the entropy thread running
+bool isEntropyThreadRunning() {
+  std::lock_guard<std::mutex> lock(s_entropyThreadLock);
+
+  return s_isEntropyRunning;
+}
+
+// getEntropyMetrics - counters of the entropy thread
+void getEntropyMetrics(EntropyMetrics& metrics) {
+  metrics.harvestNums = s_harvestNums;
+  metrics.harvestBytes = s_harvestBytes;
+  metrics.reseedNums = s_reseedNums;
+  metrics.maxReseedTime = s_maxReseedTime;
+  metrics.lastReseedTime = s_lastReseedTime;
+
+  std::lock_guard<std::mutex> lock(s_fortunaLock);
+  metrics.totalReseedNums = fortuna_get_reseed_count();
+}
+
+#ifdef NATASHA_SIMULATION
+// resetRandomSeed - reset random with fixed seed
+//                 - 只给benchmark和模拟用，结果只和seed有关
+void resetRandomSeed(uint64_t seed) {
+  std::lock_guard<std::mutex> lock(s_fortunaLock);
+  fortuna_reset_with_seed((const uint8*)&seed, sizeof(seed));
+}
+
+// setThreadRandomSeed - current thread uses xoshiro256** with seed
+//                     - 只给多线程模拟用，每个线程用自己的seed
+void setThreadRandomSeed(uint64_t seed) {
+  s_threadRandom.seed(seed);
+  s_isThreadRandom = true;
+}
+
+// setThreadRandomStream - current thread uses stream of seed
+void setThreadRandomStream(uint64_t seed, uint64_t stream) {
+  s_threadRandom.seedStream(seed, stream);
+  s_isThreadRandom = true;
+}
+
+// setThreadRandomState - current thread uses xoshiro256** from state
+void setThreadRandomState(const Xoshiro256& state) {
+  s_threadRandom = state;
+  s_isThreadRandom = true;
+}
+
+// setThreadRandomReplay - current thread draws from pReplay instead of the rng
+RandomReplay* setThreadRandomReplay(RandomReplay* pReplay) {
+  auto pLast = s_pThreadReplay;
+  s_pThreadReplay = pReplay;
+
+  return pLast;
+}
+
+// clearThreadRandomSeed - current thread uses fortuna again
+void clearThreadRandomSeed() { s_isThreadRandom = false; }
+#endif  // NATASHA_SIMULATION
+
+}  // namespace natasha
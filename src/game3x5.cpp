@@ -1,5 +1,9 @@
 #include "../include/game3x5.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <fstream>
+#include <google/protobuf/wrappers.pb.h>
 #include <streambuf>
 #include <string>
 #include "../include/csvfile.h"
@@ -180,6 +184,25 @@ void loadLines3X5FromPB(Lines3X5& lines, const natashapb::Lines* pLines) {
   }
 }
 
+// _parseStopWeight - a cell of W1 - W5, false if it is empty or not an int
+//   - 不用 std::stoi，空格子或者不是数字会抛异常
+static bool _parseStopWeight(const char* str, int& weight) {
+  if (str == NULL || str[0] == '\0') {
+    return false;
+  }
+
+  char* pEnd = NULL;
+  errno = 0;
+  long v = strtol(str, &pEnd, 10);
+  if (errno != 0 || *pEnd != '\0' || v < INT_MIN || v > INT_MAX) {
+    return false;
+  }
+
+  weight = (int)v;
+
+  return true;
+}
+
 // loadNormalReels - reelstrips.csv
 void loadNormalReels3X5(const char* fn, NormalReels3X5& scr) {
   scr.clear();
@@ -260,6 +283,73 @@ void loadNormalReels3X5(const char* fn, NormalReels3X5& scr) {
         scr.setReels(4, i, p5);
       }
     }
+
+    // W1 - W5 是可选的停止位置权重，没有就是均匀的
+    const char* lstWeightName[] = {"W1", "W2", "W3", "W4", "W5"};
+    for (int x = 0; x < 5; ++x) {
+      if (csv.getLength() <= 0 || csv.get(0, lstWeightName[x])[0] == '\0') {
+        continue;
+      }
+
+      std::vector<int> lstWeight(len[x]);
+      bool isvalid = true;
+      for (int i = 0; i < len[x] && isvalid; ++i) {
+        isvalid = _parseStopWeight(csv.get(i, lstWeightName[x]), lstWeight[i]);
+      }
+
+      if (!isvalid || !scr.setStopWeights(x, lstWeight)) {
+        printf("loadNormalReels3X5 %s invalid weights of reel%d\n", fn, x);
+
+        scr.clear();
+
+        return;
+      }
+    }
+  }
+}
+
+// loadNormalReelsSet3X5 - reelsset.csv, reels is the filename in cfgpath,
+//                         weight is the weight of the reels
+void loadNormalReelsSet3X5(const char* cfgpath, const char* fn,
+                           NormalReelsSet3X5& set) {
+  set.clear();
+
+  CSVFile csv;
+
+  if (csv.load(fn)) {
+    for (int i = 0; i < csv.getLength(); ++i) {
+      auto pReels = set.newReels(std::stoi(csv.get(i, "weight")));
+
+      loadNormalReels3X5(pathAppend(cfgpath, csv.get(i, "reels")).c_str(),
+                         *pReels);
+    }
+
+    if (!set.rebuildWeights()) {
+      set.clear();
+    }
+  }
+}
+
+// loadNormalReelsSet3X5FromPB - lstfn[i] is the reels, weight is
+//                               cfg.weights(i)
+void loadNormalReelsSet3X5FromPB(const char* cfgpath,
+                                 const FileNameList& lstfn,
+                                 const ::natashapb::WeightConfig& cfg,
+                                 NormalReelsSet3X5& set) {
+  set.clear();
+
+  if (!isValidWeightConfig(cfg) || cfg.weights_size() != (int)lstfn.size()) {
+    return;
+  }
+
+  for (size_t i = 0; i < lstfn.size(); ++i) {
+    auto pReels = set.newReels(cfg.weights(i));
+
+    loadNormalReels3X5(pathAppend(cfgpath, lstfn[i]).c_str(), *pReels);
+  }
+
+  if (!set.rebuildWeights()) {
+    set.clear();
   }
 }
 
@@ -270,11 +360,22 @@ void _randomNewReels3x5(const NormalReels3X5& reels,
   auto sb = pNRRR->mutable_symbolblock();
   auto sb3x5 = sb->mutable_sb3x5();
 
-  for (int x = 0; x < 5; ++x) {
-    // uint32_t cr = rand() % reels.getReelsLength(
-    //                            x);  // randomScale(reels.getReelsLength(x));
-    uint32_t cr = randomScale(reels.getReelsLength(x));
-    pNRRR->add_reelsindex(cr);
+  if (reels.hasStopWeights()) {
+    for (int x = 0; x < 5; ++x) {
+      pNRRR->add_reelsindex(reels.randomStop(x));
+    }
+  } else {
+    // 5 个停止位置一次取
+    uint32_t lstMax[5], lstStop[5];
+    for (int x = 0; x < 5; ++x) {
+      lstMax[x] = reels.getReelsLength(x);
+    }
+
+    randomScaleList(lstStop, lstMax, 5);
+
+    for (int x = 0; x < 5; ++x) {
+      pNRRR->add_reelsindex(lstStop[x]);
+    }
   }
 
 #ifdef NATASHA_DEBUG
@@ -283,23 +384,29 @@ void _randomNewReels3x5(const NormalReels3X5& reels,
          pNRRR->reelsindex(4));
 #endif  // NATASHA_DEBUG
 
-  sb3x5->set_dat0_0(reels.getSymbol(0, pNRRR->reelsindex(0)));
-  sb3x5->set_dat0_1(reels.getSymbol(1, pNRRR->reelsindex(1)));
-  sb3x5->set_dat0_2(reels.getSymbol(2, pNRRR->reelsindex(2)));
-  sb3x5->set_dat0_3(reels.getSymbol(3, pNRRR->reelsindex(3)));
-  sb3x5->set_dat0_4(reels.getSymbol(4, pNRRR->reelsindex(4)));
-
-  sb3x5->set_dat1_0(reels.getSymbol(0, pNRRR->reelsindex(0) + 1));
-  sb3x5->set_dat1_1(reels.getSymbol(1, pNRRR->reelsindex(1) + 1));
-  sb3x5->set_dat1_2(reels.getSymbol(2, pNRRR->reelsindex(2) + 1));
-  sb3x5->set_dat1_3(reels.getSymbol(3, pNRRR->reelsindex(3) + 1));
-  sb3x5->set_dat1_4(reels.getSymbol(4, pNRRR->reelsindex(4) + 1));
-
-  sb3x5->set_dat2_0(reels.getSymbol(0, pNRRR->reelsindex(0) + 2));
-  sb3x5->set_dat2_1(reels.getSymbol(1, pNRRR->reelsindex(1) + 2));
-  sb3x5->set_dat2_2(reels.getSymbol(2, pNRRR->reelsindex(2) + 2));
-  sb3x5->set_dat2_3(reels.getSymbol(3, pNRRR->reelsindex(3) + 2));
-  sb3x5->set_dat2_4(reels.getSymbol(4, pNRRR->reelsindex(4) + 2));
+  const SymbolType* w0 = reels.getWindow(0, pNRRR->reelsindex(0));
+  const SymbolType* w1 = reels.getWindow(1, pNRRR->reelsindex(1));
+  const SymbolType* w2 = reels.getWindow(2, pNRRR->reelsindex(2));
+  const SymbolType* w3 = reels.getWindow(3, pNRRR->reelsindex(3));
+  const SymbolType* w4 = reels.getWindow(4, pNRRR->reelsindex(4));
+
+  sb3x5->set_dat0_0(w0[0]);
+  sb3x5->set_dat0_1(w1[0]);
+  sb3x5->set_dat0_2(w2[0]);
+  sb3x5->set_dat0_3(w3[0]);
+  sb3x5->set_dat0_4(w4[0]);
+
+  sb3x5->set_dat1_0(w0[1]);
+  sb3x5->set_dat1_1(w1[1]);
+  sb3x5->set_dat1_2(w2[1]);
+  sb3x5->set_dat1_3(w3[1]);
+  sb3x5->set_dat1_4(w4[1]);
+
+  sb3x5->set_dat2_0(w0[2]);
+  sb3x5->set_dat2_1(w1[2]);
+  sb3x5->set_dat2_2(w2[2]);
+  sb3x5->set_dat2_3(w3[2]);
+  sb3x5->set_dat2_4(w4[2]);
 }
 
 // _fillReels3x5 - fill with NormalReels
@@ -307,40 +414,38 @@ void _fillReels3x5(const NormalReels3X5& reels,
                    const ::natashapb::SymbolBlock3X5& last3x5,
                    ::natashapb::NormalReelsRandomResult3X5* pNRRR,
                    FuncOnFillReels onfillreels) {
-  assert(pNRRR->reelsindex_size() == 5);
+#ifdef NATASHA_DEBUG
+  printf("_fillReels3x5 start index: \n %d %d %d %d %d\n", pNRRR->reelsindex(0),
+         pNRRR->reelsindex(1), pNRRR->reelsindex(2), pNRRR->reelsindex(3),
+         pNRRR->reelsindex(4));
+#endif  // NATASHA_DEBUG
 
-  ::natashapb::SymbolBlock* pSB = pNRRR->mutable_symbolblock();
-  ::natashapb::SymbolBlock3X5* pSB35 = pSB->mutable_sb3x5();
+  fillReels3x5T(reels, last3x5, pNRRR, FillFunc(onfillreels));
 
 #ifdef NATASHA_DEBUG
   printf("_fillReels3x5 start index: \n %d %d %d %d %d\n", pNRRR->reelsindex(0),
          pNRRR->reelsindex(1), pNRRR->reelsindex(2), pNRRR->reelsindex(3),
          pNRRR->reelsindex(4));
 #endif  // NATASHA_DEBUG
+}
 
-  for (int y = 2; y >= 0; --y) {
-    for (int x = 0; x < 5; ++x) {
-      auto curs = getSymbolBlock3X5(&last3x5, x, y);
-      if (curs == -1) {
-        auto ci = pNRRR->reelsindex(x) - 1;
-        auto cs = reels.getSymbolEx(x, ci);
+// _getFillReels3x5 - random new reels and return NULL, or return the
+//                    NormalReelsRandomResult3X5 need to fill
+::natashapb::NormalReelsRandomResult3X5* _getFillReels3x5(
+    const NormalReels3X5& reels, ::natashapb::RandomResult* pRandomResult,
+    const ::natashapb::UserGameModInfo* pUGMI) {
+  assert(pRandomResult != NULL);
 
-        cs = onfillreels(x, y, cs);
+  ::natashapb::NormalReelsRandomResult3X5* pNRRR =
+      pRandomResult->mutable_nrrr3x5();
 
-        setSymbolBlock3X5(pSB35, x, y, cs);
+  if (pUGMI->cascadinginfo().isend() || pNRRR->reelsindex_size() != 5) {
+    _randomNewReels3x5(reels, pNRRR);
 
-        pNRRR->set_reelsindex(x, ci);
-      } else {
-        setSymbolBlock3X5(pSB35, x, y, curs);
-      }
-    }
+    return NULL;
   }
 
-#ifdef NATASHA_DEBUG
-  printf("_fillReels3x5 start index: \n %d %d %d %d %d\n", pNRRR->reelsindex(0),
-         pNRRR->reelsindex(1), pNRRR->reelsindex(2), pNRRR->reelsindex(3),
-         pNRRR->reelsindex(4));
-#endif  // NATASHA_DEBUG
+  return pNRRR;
 }
 
 // randomReels3x5 - random normal reels
@@ -348,37 +453,59 @@ void randomReels3x5(const NormalReels3X5& reels,
                     ::natashapb::RandomResult* pRandomResult,
                     const ::natashapb::UserGameModInfo* pUGMI,
                     FuncOnFillReels onfillreels) {
+  auto pNRRR = _getFillReels3x5(reels, pRandomResult, pUGMI);
+  if (pNRRR != NULL) {
+    _fillReels3x5(reels, pUGMI->symbolblock().sb3x5(), pNRRR, onfillreels);
+  }
+}
+
+// getReelsSetIndex3x5 - the index of NormalReelsSet3X5 in RandomResult,
+//                       -1 if none
+int getReelsSetIndex3x5(const ::natashapb::RandomResult& rr) {
+  ::google::protobuf::Int32Value ri;
+  if (!rr.has_info() || !rr.info().UnpackTo(&ri)) {
+    return -1;
+  }
+
+  return ri.value();
+}
+
+// setReelsSetIndex3x5 - save the index of NormalReelsSet3X5 in RandomResult
+void setReelsSetIndex3x5(::natashapb::RandomResult* pRandomResult, int ri) {
   assert(pRandomResult != NULL);
 
-  if (pUGMI->cascadinginfo().isend()) {
-    ::natashapb::NormalReelsRandomResult3X5* pNRRR =
-        pRandomResult->mutable_nrrr3x5();
+  ::google::protobuf::Int32Value v;
+  v.set_value(ri);
 
-    _randomNewReels3x5(reels, pNRRR);
+  pRandomResult->mutable_info()->PackFrom(v);
+}
 
-    return;
-  }
+// randomReels3x5 - random normal reels, the reels is chosen from set by weight
+//                - 用的哪组 reels 存在 RandomResult 的 info 里，reelsindex
+//                  还是 5 个，消除以后还用那一组填
+void randomReels3x5(const NormalReelsSet3X5& set,
+                    ::natashapb::RandomResult* pRandomResult,
+                    const ::natashapb::UserGameModInfo* pUGMI,
+                    FuncOnFillReels onfillreels) {
+  assert(pRandomResult != NULL);
 
-  if (!pRandomResult->has_nrrr3x5()) {
-    ::natashapb::NormalReelsRandomResult3X5* pNRRR =
-        pRandomResult->mutable_nrrr3x5();
+  ::natashapb::NormalReelsRandomResult3X5* pNRRR =
+      pRandomResult->mutable_nrrr3x5();
 
-    _randomNewReels3x5(reels, pNRRR);
-  } else {
-    const ::natashapb::NormalReelsRandomResult3X5& nrrr =
-        pRandomResult->nrrr3x5();
-    if (nrrr.reelsindex_size() != 5) {
-      ::natashapb::NormalReelsRandomResult3X5* pNRRR =
-          pRandomResult->mutable_nrrr3x5();
-
-      _randomNewReels3x5(reels, pNRRR);
-    } else {
-      ::natashapb::NormalReelsRandomResult3X5* pNRRR =
-          pRandomResult->mutable_nrrr3x5();
-
-      _fillReels3x5(reels, pUGMI->symbolblock().sb3x5(), pNRRR, onfillreels);
-    }
+  int ri = getReelsSetIndex3x5(*pRandomResult);
+
+  if (pUGMI->cascadinginfo().isend() || pNRRR->reelsindex_size() != 5 ||
+      ri < 0 || ri >= set.getReelsNums()) {
+    ri = set.randomReels();
+
+    _randomNewReels3x5(set.getReels(ri), pNRRR);
+    setReelsSetIndex3x5(pRandomResult, ri);
+
+    return;
   }
+
+  _fillReels3x5(set.getReels(ri), pUGMI->symbolblock().sb3x5(), pNRRR,
+                onfillreels);
 }
 
 }  // namespace natasha
\ No newline at end of file
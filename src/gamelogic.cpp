@@ -1,4 +1,5 @@
 #include "../include/gamelogic.h"
+#include "../include/fortuna.h"
 #include <fstream>
 #include <streambuf>
 #include <string>
@@ -19,10 +20,169 @@ GameLogic::~GameLogic() {}
 
 ::natashapb::CODE GameLogic::gameCtrl(::natashapb::GameCtrl* pGameCtrl,
                                       UserInfo* pUser) {
+  auto code = procGameCtrl(pGameCtrl, pUser);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  if (m_funcProcGameCtrlResult != NULL) {
+    m_funcProcGameCtrlResult(pUser->pLogicUser);
+  }
+
+  return ::natashapb::OK;
+}
+
+// gameCtrlWithJournal - gameCtrl, and all draws of it in journal
+::natashapb::CODE GameLogic::gameCtrlWithJournal(
+    ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser,
+    RandomJournal& journal) {
+  journal.clear();
+
+  auto pLast = setThreadRandomJournal(&journal);
+  auto code = gameCtrl(pGameCtrl, pUser);
+  setThreadRandomJournal(pLast);
+
+  return code;
+}
+
+#ifdef NATASHA_SIMULATION
+// replayGameCtrl - gameCtrl with the draws of replay instead of the rng
+::natashapb::CODE GameLogic::replayGameCtrl(::natashapb::GameCtrl* pGameCtrl,
+                                            UserInfo* pUser,
+                                            RandomReplay& replay) {
+  auto pLast = setThreadRandomReplay(&replay);
+  auto code = gameCtrl(pGameCtrl, pUser);
+  setThreadRandomReplay(pLast);
+
+  return code;
+}
+#endif  // NATASHA_SIMULATION
+
+// resolveGameCtrl - gamectrl, then all the cascades & free spins after it
+//                   until iscompleted
+//                 - 一个特性要么全部完成，要么恢复到调用前，
+//                   这样 pLogicUser 和 FuncProcGameCtrlResult 保存的一致
+::natashapb::CODE GameLogic::resolveGameCtrl(
+    ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser,
+    ResolvedStepList& lstStep,
+    ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+        pLstSpinResult) {
+  assert(pGameCtrl != NULL);
+  assert(pUser != NULL);
+  assert(pUser->pLogicUser != NULL);
+
+  if (!pGameCtrl->has_spin()) {
+    return ::natashapb::INVALID_GAMECTRL_GAMEMOD;
+  }
+
+  auto pLogicUser = pUser->pLogicUser;
+
+  // 一个特性只复制一次
+  ::natashapb::UserGameLogicInfo lastLogicUser;
+  lastLogicUser.CopyFrom(*pLogicUser);
+
+  size_t lastStepNums = lstStep.size();
+  int lastSpinResultNums =
+      pLstSpinResult != NULL ? pLstSpinResult->size() : 0;
+
+  auto code = procResolveGameCtrl(pGameCtrl, pUser, lstStep, pLstSpinResult);
+  if (code != ::natashapb::OK) {
+    pLogicUser->Swap(&lastLogicUser);
+
+    lstStep.resize(lastStepNums);
+
+    if (pLstSpinResult != NULL) {
+      pLstSpinResult->DeleteSubrange(
+          lastSpinResultNums, pLstSpinResult->size() - lastSpinResultNums);
+    }
+
+    return code;
+  }
+
+  if (m_funcProcGameCtrlResult != NULL) {
+    m_funcProcGameCtrlResult(pLogicUser);
+  }
+
+  return ::natashapb::OK;
+}
+
+// procResolveGameCtrl - resolveGameCtrl without FuncProcGameCtrlResult and
+//                       without restore
+::natashapb::CODE GameLogic::procResolveGameCtrl(
+    ::natashapb::GameCtrl* pGameCtrl, UserInfo* pUser,
+    ResolvedStepList& lstStep,
+    ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+        pLstSpinResult) {
+  auto pLogicUser = pUser->pLogicUser;
+
+  ::natashapb::GameCtrl gamectrlBG;
+  gamectrlBG.CopyFrom(*pGameCtrl);
+
+  ::natashapb::GameCtrl gamectrlFG;
+  auto freespin = gamectrlFG.mutable_freespin();
+  freespin->set_bet(pGameCtrl->spin().bet());
+  freespin->set_lines(pGameCtrl->spin().lines());
+  freespin->set_times(pGameCtrl->spin().times());
+
+  CtrlID ctrlid = pGameCtrl->ctrlid();
+
+  for (int i = 0; i < MAX_RESOLVE_GAMECTRL_NUMS; ++i) {
+    auto curmod = this->getMainGameMod(pUser, false);
+    assert(curmod != NULL);
+
+    auto module = curmod->getGameModType();
+
+    ::natashapb::GameCtrl* pCurGameCtrl = NULL;
+    if (i == 0) {
+      pCurGameCtrl = pGameCtrl;
+    } else if (module == ::natashapb::BASE_GAME) {
+      pCurGameCtrl = &gamectrlBG;
+    } else if (module == ::natashapb::FREE_GAME) {
+      pCurGameCtrl = &gamectrlFG;
+    } else {
+      return ::natashapb::INVALID_GAMECTRL_GAMEMOD;
+    }
+
+    pCurGameCtrl->set_ctrlid(ctrlid++);
+
+    auto code = procGameCtrl(pCurGameCtrl, pUser);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    auto pUGMI = this->getUserGameModInfo(pUser, module);
+    assert(pUGMI != NULL);
+
+    auto& spinret = pUGMI->spinresult();
+
+    ResolvedStep rs;
+    rs.module = module;
+    rs.ctrlid = pCurGameCtrl->ctrlid();
+    buildScenarioStep(spinret, rs.step);
+
+    lstStep.push_back(rs);
+
+    if (pLstSpinResult != NULL) {
+      pLstSpinResult->Add()->CopyFrom(spinret);
+    }
+
+    if (pLogicUser->iscompleted()) {
+      return ::natashapb::OK;
+    }
+  }
+
+  return ::natashapb::INVALID_CASCADING_FREESTATE;
+}
+
+// procGameCtrl - gamectrl without FuncProcGameCtrlResult
+::natashapb::CODE GameLogic::procGameCtrl(::natashapb::GameCtrl* pGameCtrl,
+                                          UserInfo* pUser) {
   assert(pGameCtrl != NULL);
   assert(pUser != NULL);
   assert(pUser->pLogicUser != NULL);
 
+  NATASHA_PROFILE_SCOPE(PROFILE_GAMECTRL);
+
   auto pLogicUser = pUser->pLogicUser;
 
   auto curmod = this->getMainGameMod(pUser, false);
@@ -31,9 +191,15 @@ GameLogic::~GameLogic() {}
   auto curugmi = this->getUserGameModInfo(pUser, curmod->getGameModType());
   assert(curugmi != NULL);
 
-  auto code = curmod->reviewGameCtrl(pGameCtrl, curugmi);
-  if (code != ::natashapb::OK) {
-    return code;
+  ::natashapb::CODE code;
+
+  {
+    NATASHA_PROFILE_SCOPE(PROFILE_REVIEWGAMECTRL);
+
+    code = curmod->reviewGameCtrl(pGameCtrl, curugmi);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
   }
 
   code = curmod->onGameCtrl(pGameCtrl, pUser, curugmi);
@@ -52,11 +218,9 @@ GameLogic::~GameLogic() {}
 
   pLogicUser->set_iscompleted(nextmod->isCompeleted(nextugmi));
 
-  if (m_funcProcGameCtrlResult != NULL) {
-    m_funcProcGameCtrlResult(pLogicUser);
-  }
-
 #ifdef NATASHA_COUNTRTP
+  NATASHA_PROFILE_SCOPE(PROFILE_COUNTRTP);
+
   if (pGameCtrl->has_spin()) {
     // printf("gamectrl.spin.realbet %lld\n", pGameCtrl->spin().realbet());
 
@@ -66,15 +230,7 @@ GameLogic::~GameLogic() {}
   }
 
   if (curugmi->has_spinresult()) {
-    auto spinret = curugmi->spinresult();
-
-    for (auto i = 0; i < curugmi->spinresult().lstgri_size(); ++i) {
-      auto curgri = curugmi->spinresult().lstgri(i);
-      onRTPAddPayoutGRI(curmod->getGameModType(), spinret, curgri,
-                        getUserGameModInfo(pUser, curmod->getGameModType()));
-    }
-
-    onRTPAddPayout(curmod->getGameModType(), spinret.realwin());
+    onRTPSpinResult(curmod->getGameModType(), curugmi->spinresult(), curugmi);
   }
 #endif  // NATASHA_COUNTRTP
 
@@ -98,6 +254,49 @@ GameLogic::~GameLogic() {}
   return ::natashapb::OK;
 }
 
+// buildInitScenarios - build initial scenarios index for game module
+//   Only for init
+::natashapb::CODE GameLogic::buildInitScenarios(::natashapb::GAMEMODTYPE gmt,
+                                                void* pCurConfig) {
+  auto it = m_mapGameMod.find(gmt);
+  assert(it != m_mapGameMod.end());
+
+  UserInfo ui;
+  ui.pLogicUser = NULL;
+  ui.pCurConfig = pCurConfig;
+
+  return it->second->buildInitScenarios(&ui);
+}
+
+// releaseInitScenarios - release initial scenarios index for game module
+//   Only for init
+void GameLogic::releaseInitScenarios(::natashapb::GAMEMODTYPE gmt,
+                                     const void* pCurConfig) {
+  auto it = m_mapGameMod.find(gmt);
+  assert(it != m_mapGameMod.end());
+
+  UserInfo ui;
+  ui.pLogicUser = NULL;
+  ui.pCurConfig = (void*)pCurConfig;
+
+  it->second->releaseInitScenarios(&ui);
+}
+
+// buildScenarioOutcomes - build scenario outcomes for game module
+//   Only for init
+::natashapb::CODE GameLogic::buildScenarioOutcomes(
+    ::natashapb::GAMEMODTYPE gmt, void* pCurConfig,
+    const ::natashapb::GameCtrl* pGameCtrl) {
+  auto it = m_mapGameMod.find(gmt);
+  assert(it != m_mapGameMod.end());
+
+  UserInfo ui;
+  ui.pLogicUser = NULL;
+  ui.pCurConfig = pCurConfig;
+
+  return it->second->buildScenarioOutcomes(&ui, pGameCtrl);
+}
+
 // startGameMod - start game module for user
 //   Only for gamectrl
 ::natashapb::CODE GameLogic::startGameMod(
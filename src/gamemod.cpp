@@ -2,6 +2,7 @@
 #include <fstream>
 #include <streambuf>
 #include <string>
+#include "../include/fortuna.h"
 #include "../include/gamelogic.h"
 #include "../include/natasha.h"
 
@@ -16,6 +17,8 @@ namespace natasha {
 
 // makeInitScenario - make a initial scenario
 //                  - 产生一个初始局面，不中奖的
+//                  - 没有 buildInitScenarios 的 config 还是随机重试，
+//                    MAX_NUMS_MAKEINITIALSCENARIO 次都中奖会失败
 ::natashapb::CODE SlotsGameMod::makeInitScenario(
     ::natashapb::GameCtrl* pGameCtrl, const UserInfo* pUser,
     ::natashapb::UserGameModInfo* pUGMI) {
@@ -25,6 +28,19 @@ namespace natasha {
 
   //   auto pGameCtrl = new ::natashapb::GameCtrl();
 
+  auto it = m_mapInitScenario.find(pUser->pCurConfig);
+  if (it != m_mapInitScenario.end() && !it->second->empty()) {
+    uint32_t cr = randomScale(it->second->size());
+    assert(cr < it->second->size());
+
+    const InitScenario* pIS = (*it->second)[cr];
+
+    pUGMI->mutable_randomresult()->CopyFrom(pIS->randomResult);
+    pUGMI->mutable_spinresult()->CopyFrom(pIS->spinResult);
+
+    return ::natashapb::OK;
+  }
+
   for (int i = 0; i < MAX_NUMS_MAKEINITIALSCENARIO; ++i) {
     pUGMI->clear_randomresult();
     auto code = this->randomReels(pUGMI->mutable_randomresult(), pGameCtrl,
@@ -52,6 +68,310 @@ namespace natasha {
   return ::natashapb::ERR_MAKE_INITIAL_SCENARIO;
 }
 
+// buildInitScenarios - build the initial scenarios index for user config
+//                    - 预先生成不中奖的初始局面，makeInitScenario直接从里面随机
+::natashapb::CODE SlotsGameMod::buildInitScenarios(const UserInfo* pUser) {
+  assert(pUser != NULL);
+
+  ::natashapb::GameCtrl gamectrl;
+  ::natashapb::UserGameModInfo ugmi;
+
+  auto code = this->clearUGMI(&ugmi);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ugmi.mutable_cascadinginfo()->set_isend(true);
+
+  // 能枚举的就全部枚举，否则随机采样
+  int nums = this->getScenarioNums(pUser);
+  bool isEnumerable = nums > 0;
+  if (!isEnumerable) {
+    nums = MAX_NUMS_BUILDINITSCENARIO;
+  }
+
+  InitScenarioList* pLst = new InitScenarioList();
+
+  for (int i = 0; i < nums; ++i) {
+    ugmi.clear_randomresult();
+
+    if (isEnumerable) {
+      code = this->setScenario(ugmi.mutable_randomresult(), i, pUser);
+    } else {
+      code = this->randomReels(ugmi.mutable_randomresult(), &gamectrl, &ugmi,
+                               pUser);
+    }
+
+    if (code == ::natashapb::OK) {
+      code = this->countSpinResult(ugmi.mutable_spinresult(), &gamectrl,
+                                   ugmi.mutable_randomresult(), &ugmi, pUser);
+    }
+
+    if (code != ::natashapb::OK) {
+      for (auto pIS : *pLst) {
+        delete pIS;
+      }
+
+      delete pLst;
+
+      return code;
+    }
+
+    if (ugmi.spinresult().lstgri_size() == 0) {
+      InitScenario* pIS = new InitScenario();
+
+      pIS->randomResult.CopyFrom(ugmi.randomresult());
+      pIS->spinResult.CopyFrom(ugmi.spinresult());
+
+      pLst->push_back(pIS);
+    }
+  }
+
+  if (pLst->empty()) {
+    delete pLst;
+
+    return ::natashapb::ERR_MAKE_INITIAL_SCENARIO;
+  }
+
+  auto it = m_mapInitScenario.find(pUser->pCurConfig);
+  if (it != m_mapInitScenario.end()) {
+    for (auto pIS : *(it->second)) {
+      delete pIS;
+    }
+
+    delete it->second;
+  }
+
+  m_mapInitScenario[pUser->pCurConfig] = pLst;
+
+#ifdef NATASHA_DEBUG
+  printf("buildInitScenarios OK (%d/%d)\n", (int)pLst->size(), nums);
+#endif  // NATASHA_DEBUG
+
+  return ::natashapb::OK;
+}
+
+// releaseInitScenarios - release the initial scenarios for user config
+//                      - 之后 makeInitScenario 对这个 config 会随机重试
+void SlotsGameMod::releaseInitScenarios(const UserInfo* pUser) {
+  assert(pUser != NULL);
+
+  auto it = m_mapInitScenario.find(pUser->pCurConfig);
+  if (it == m_mapInitScenario.end()) {
+    return;
+  }
+
+  for (auto pIS : *(it->second)) {
+    delete pIS;
+  }
+
+  delete it->second;
+
+  m_mapInitScenario.erase(it);
+}
+
+// clearInitScenarios
+void SlotsGameMod::clearInitScenarios() {
+  for (auto it = m_mapInitScenario.begin(); it != m_mapInitScenario.end();
+       ++it) {
+    for (auto pIS : *(it->second)) {
+      delete pIS;
+    }
+
+    delete it->second;
+  }
+
+  m_mapInitScenario.clear();
+}
+
+// getInitScenarioNums - nums of the initial scenarios for user config
+int SlotsGameMod::getInitScenarioNums(const UserInfo* pUser) const {
+  assert(pUser != NULL);
+
+  auto it = m_mapInitScenario.find(pUser->pCurConfig);
+  if (it != m_mapInitScenario.end()) {
+    return it->second->size();
+  }
+
+  return 0;
+}
+
+// resolveScenario - resolve the index-th scenario to the end of cascade
+//                 - pLstSpinResult is NULL if no need to expand the steps
+//                 - 需要播放动画时才展开每一步的 SpinResult
+::natashapb::CODE SlotsGameMod::resolveScenario(
+    const UserInfo* pUser, const ::natashapb::GameCtrl* pGameCtrl, int index,
+    ScenarioOutcome& outcome,
+    ::google::protobuf::RepeatedPtrField< ::natashapb::SpinResult>*
+        pLstSpinResult) {
+  assert(pUser != NULL);
+  assert(pGameCtrl != NULL);
+
+  outcome.totalWin = 0;
+  outcome.cascadeNums = 0;
+  outcome.fgNums = 0;
+  outcome.lstStep.clear();
+
+  // 用临时的用户数据跑真实的逻辑，BG 里触发 FG 也只影响临时数据
+  ::natashapb::UserGameLogicInfo ugi;
+  UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = pUser->pCurConfig;
+
+  auto pUGMI = m_logic.getUserGameModInfo(&user, m_gmt);
+  assert(pUGMI != NULL);
+
+  auto code = this->clearUGMI(pUGMI);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  pUGMI->mutable_cascadinginfo()->set_isend(true);
+
+  for (int i = 0; i < MAX_NUMS_SCENARIOSTEP; ++i) {
+    // clearUGMI is the state of onSpinStart for the first step
+    if (i == 0) {
+      code = this->setScenario(pUGMI->mutable_randomresult(), index, &user);
+    } else {
+      code = this->onSpinStart(pUGMI, pGameCtrl, &user);
+      if (code == ::natashapb::OK) {
+        code = this->randomReels(pUGMI->mutable_randomresult(), pGameCtrl,
+                                 pUGMI, &user);
+      }
+    }
+
+    if (code == ::natashapb::OK) {
+      code = this->countSpinResult(pUGMI->mutable_spinresult(), pGameCtrl,
+                                   pUGMI->mutable_randomresult(), pUGMI,
+                                   &user);
+    }
+
+    if (code == ::natashapb::OK) {
+      code = this->procSpinResult(pUGMI, pGameCtrl,
+                                  pUGMI->mutable_spinresult(),
+                                  pUGMI->mutable_randomresult(), &user);
+    }
+
+    if (code == ::natashapb::OK) {
+      code = this->onSpinEnd(pUGMI, pGameCtrl, pUGMI->mutable_spinresult(),
+                             pUGMI->mutable_randomresult(), &user);
+    }
+
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    auto& spinret = pUGMI->spinresult();
+
+    ScenarioStep step;
+    buildScenarioStep(spinret, step);
+
+    outcome.lstStep.push_back(step);
+    outcome.totalWin += step.realWin;
+    outcome.fgNums += step.fgNums;
+    outcome.cascadeNums++;
+
+    if (pLstSpinResult != NULL) {
+      pLstSpinResult->Add()->CopyFrom(spinret);
+    }
+
+    if (pUGMI->cascadinginfo().isend()) {
+      return ::natashapb::OK;
+    }
+  }
+
+  return ::natashapb::INVALID_REELS_CFG;
+}
+
+// buildScenarioOutcomes - resolve every scenario to the end of cascade
+//                       - 只有能枚举的 reels 才可以
+::natashapb::CODE SlotsGameMod::buildScenarioOutcomes(
+    const UserInfo* pUser, const ::natashapb::GameCtrl* pGameCtrl) {
+  assert(pUser != NULL);
+  assert(pGameCtrl != NULL);
+
+  int nums = this->getScenarioNums(pUser);
+  if (nums <= 0) {
+    return ::natashapb::ERR_NO_OVERLOADED_INTERFACE;
+  }
+
+  ScenarioOutcomeList* pLst = new ScenarioOutcomeList(nums);
+
+  for (int i = 0; i < nums; ++i) {
+    auto code = resolveScenario(pUser, pGameCtrl, i, (*pLst)[i], NULL);
+    if (code != ::natashapb::OK) {
+      delete pLst;
+
+      return code;
+    }
+  }
+
+  auto it = m_mapScenarioOutcome.find(pUser->pCurConfig);
+  if (it != m_mapScenarioOutcome.end()) {
+    delete it->second;
+  }
+
+  m_mapScenarioOutcome[pUser->pCurConfig] = pLst;
+
+  return ::natashapb::OK;
+}
+
+// clearScenarioOutcomes
+void SlotsGameMod::clearScenarioOutcomes() {
+  for (auto it = m_mapScenarioOutcome.begin(); it != m_mapScenarioOutcome.end();
+       ++it) {
+    delete it->second;
+  }
+
+  m_mapScenarioOutcome.clear();
+}
+
+// getScenarioOutcomeNums - nums of the scenario outcomes for user config
+int SlotsGameMod::getScenarioOutcomeNums(const UserInfo* pUser) const {
+  assert(pUser != NULL);
+
+  auto it = m_mapScenarioOutcome.find(pUser->pCurConfig);
+  if (it != m_mapScenarioOutcome.end()) {
+    return it->second->size();
+  }
+
+  return 0;
+}
+
+// getScenarioOutcome - get the index-th scenario outcome, NULL if not found
+const ScenarioOutcome* SlotsGameMod::getScenarioOutcome(const UserInfo* pUser,
+                                                        int index) const {
+  assert(pUser != NULL);
+
+  auto it = m_mapScenarioOutcome.find(pUser->pCurConfig);
+  if (it == m_mapScenarioOutcome.end()) {
+    return NULL;
+  }
+
+  if (index < 0 || index >= (int)it->second->size()) {
+    return NULL;
+  }
+
+  return &((*it->second)[index]);
+}
+
+// randomScenarioOutcome - one random draw and a table read
+//                       - 只适用于 scenario 是均匀随机的 reels
+const ScenarioOutcome* SlotsGameMod::randomScenarioOutcome(
+    const UserInfo* pUser, int& index) const {
+  assert(pUser != NULL);
+
+  auto it = m_mapScenarioOutcome.find(pUser->pCurConfig);
+  if (it == m_mapScenarioOutcome.end() || it->second->empty()) {
+    return NULL;
+  }
+
+  index = randomScale(it->second->size());
+  assert(index >= 0 && index < (int)it->second->size());
+
+  return &((*it->second)[index]);
+}
+
 // clearRespinHistory
 ::natashapb::CODE SlotsGameMod::clearRespinHistory(
     ::natashapb::UserGameModInfo* pUser) {
@@ -0,0 +1,92 @@
+#include "../include/markovchain.h"
+#include <math.h>
+
+namespace natasha {
+
+// init - clear and resize
+void MarkovChain::init(int stateNums) {
+  assert(stateNums > 0);
+
+  m_lstTransition.clear();
+  m_lstTransition.resize(stateNums);
+
+  m_lstReward.clear();
+  m_lstReward.resize(stateNums, 0);
+}
+
+// addTransition - from -> to with probability p
+void MarkovChain::addTransition(int from, int to, double p) {
+  assert(from >= 0 && from < getStateNums());
+  assert(to >= 0 && to < getStateNums());
+
+  if (p <= 0) {
+    return;
+  }
+
+  auto& lst = m_lstTransition[from];
+  for (auto it = lst.begin(); it != lst.end(); ++it) {
+    if (it->to == to) {
+      it->p += p;
+
+      return;
+    }
+  }
+
+  Transition t;
+  t.to = to;
+  t.p = p;
+
+  lst.push_back(t);
+}
+
+// addReward - reward when leaving the state
+void MarkovChain::addReward(int state, double r) {
+  assert(state >= 0 && state < getStateNums());
+
+  m_lstReward[state] += r;
+}
+
+// setReward - reward when leaving the state
+void MarkovChain::setReward(int state, double r) {
+  assert(state >= 0 && state < getStateNums());
+
+  m_lstReward[state] = r;
+}
+
+// solve - expected total reward before absorption for every state
+//       - Gauss-Seidel, return false if it does not converge
+bool MarkovChain::solve(std::vector<double>& lstValue, double eps,
+                        int maxIterations) const {
+  int nums = getStateNums();
+
+  lstValue.clear();
+  lstValue.resize(nums, 0);
+
+  for (int i = 0; i < maxIterations; ++i) {
+    double maxdelta = 0;
+
+    for (int s = 0; s < nums; ++s) {
+      double v = m_lstReward[s];
+
+      auto& lst = m_lstTransition[s];
+      for (auto it = lst.begin(); it != lst.end(); ++it) {
+        v += it->p * lstValue[it->to];
+      }
+
+      double delta = fabs(v - lstValue[s]);
+      if (delta > maxdelta) {
+        maxdelta = delta;
+      }
+
+      lstValue[s] = v;
+    }
+
+    if (maxdelta <= eps) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace natasha
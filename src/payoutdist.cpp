@@ -0,0 +1,154 @@
+#include "../include/payoutdist.h"
+
+namespace natasha {
+
+// init - clear and resize
+void PayoutDist::init(int maxWin, int unit) {
+  assert(maxWin >= 0);
+  assert(unit > 0);
+
+  m_unit = unit;
+  m_lst.clear();
+  m_lst.resize(maxWin / unit + 1, 0);
+  m_maxIndex = -1;
+}
+
+// add - add probability p to win
+void PayoutDist::add(MoneyType win, double p) {
+  assert(win >= 0);
+  assert(win % m_unit == 0);
+
+  int maxIndex = (int)m_lst.size() - 1;
+  int index = win / m_unit > maxIndex ? maxIndex : (int)(win / m_unit);
+
+  m_lst[index] += p;
+
+  if (index > m_maxIndex) {
+    m_maxIndex = index;
+  }
+}
+
+// addShift - this += p * (dist shifted by win)
+void PayoutDist::addShift(const PayoutDist& dist, MoneyType win, double p) {
+  assert(dist.m_unit == m_unit);
+  assert(win >= 0);
+  assert(win % m_unit == 0);
+
+  if (dist.m_maxIndex < 0) {
+    return;
+  }
+
+  // 这里是卷积最内层的循环，不用 add
+  int maxIndex = (int)m_lst.size() - 1;
+  MoneyType begin = win / m_unit;
+  int i = 0;
+
+  for (; i <= dist.m_maxIndex && begin + i < maxIndex; ++i) {
+    m_lst[begin + i] += p * dist.m_lst[i];
+  }
+
+  for (; i <= dist.m_maxIndex; ++i) {
+    m_lst[maxIndex] += p * dist.m_lst[i];
+  }
+
+  int lastIndex = begin + dist.m_maxIndex < maxIndex
+                      ? (int)(begin + dist.m_maxIndex)
+                      : maxIndex;
+  if (lastIndex > m_maxIndex) {
+    m_maxIndex = lastIndex;
+  }
+}
+
+// convolve - this = a * b, the sum of 2 independent wins
+//          - this can not be a or b
+void PayoutDist::convolve(const PayoutDist& a, const PayoutDist& b) {
+  assert(this != &a);
+  assert(this != &b);
+
+  assert(a.m_unit == b.m_unit);
+
+  init(a.getMaxWin(), a.m_unit);
+
+  // b 一般是单局的分布，非零的比较少，放在外层
+  for (int j = 0; j <= b.m_maxIndex; ++j) {
+    if (b.m_lst[j] > 0) {
+      addShift(a, (MoneyType)j * m_unit, b.m_lst[j]);
+    }
+  }
+}
+
+// power - this = dist ^ n, the sum of n independent wins
+void PayoutDist::power(const PayoutDist& dist, int n) {
+  assert(this != &dist);
+  assert(n >= 0);
+
+  init(dist.getMaxWin(), dist.m_unit);
+  add(0, 1);
+
+  PayoutDist tmp(dist.getMaxWin(), dist.m_unit);
+  for (int i = 0; i < n; ++i) {
+    tmp.convolve(*this, dist);
+    m_lst.swap(tmp.m_lst);
+    std::swap(m_maxIndex, tmp.m_maxIndex);
+  }
+}
+
+// prune - drop the probabilities less than minProb
+void PayoutDist::prune(double minProb) {
+  int maxIndex = -1;
+
+  for (int i = 0; i <= m_maxIndex; ++i) {
+    if (m_lst[i] < minProb) {
+      m_lst[i] = 0;
+    } else {
+      maxIndex = i;
+    }
+  }
+
+  m_maxIndex = maxIndex;
+}
+
+double PayoutDist::getProb(MoneyType win) const {
+  if (win < 0 || win > getMaxWin() || win % m_unit != 0) {
+    return 0;
+  }
+
+  return m_lst[win / m_unit];
+}
+
+double PayoutDist::getTotalProb() const {
+  double total = 0;
+
+  for (int i = 0; i <= m_maxIndex; ++i) {
+    total += m_lst[i];
+  }
+
+  return total;
+}
+
+// getMean - mean of win
+double PayoutDist::getMean() const {
+  double total = 0;
+
+  for (int i = 0; i <= m_maxIndex; ++i) {
+    total += m_lst[i] * i * m_unit;
+  }
+
+  return total;
+}
+
+// getRangeProb - probability of win in [minWin, maxWin)
+double PayoutDist::getRangeProb(MoneyType minWin, MoneyType maxWin) const {
+  double total = 0;
+
+  for (int i = 0; i <= m_maxIndex; ++i) {
+    MoneyType win = (MoneyType)i * m_unit;
+    if (win >= minWin && win < maxWin) {
+      total += m_lst[i];
+    }
+  }
+
+  return total;
+}
+
+}  // namespace natasha
@@ -0,0 +1,264 @@
+#include "../include/profile.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace natasha {
+
+const char* PROFILE_STAGE_NAME[PROFILE_STAGE_NUMS] = {
+    "gameCtrl",        "reviewGameCtrl", "onSpinStart", "randomReels",
+    "countSpinResult", "procSpinResult", "onSpinEnd",   "countRTP"};
+
+void ProfileHistogram::clear() { memset(this, 0, sizeof(ProfileHistogram)); }
+
+// getValueAtPercentile - percentile in [0, 100], return ns
+uint64_t ProfileHistogram::getValueAtPercentile(double percentile) const {
+  if (nums == 0) {
+    return 0;
+  }
+
+  uint64_t target = (uint64_t)(percentile / 100 * nums + 0.5);
+  if (target < 1) {
+    target = 1;
+  } else if (target > nums) {
+    target = nums;
+  }
+
+  uint64_t cur = 0;
+  for (int i = 0; i < PROFILE_BUCKET_NUMS; ++i) {
+    cur += counts[i];
+    if (cur >= target) {
+      return getProfileBucketValue(i);
+    }
+  }
+
+  return getProfileBucketValue(PROFILE_BUCKET_NUMS - 1);
+}
+
+// getProfileBucket - value(ns) -> bucket index
+int getProfileBucket(uint64_t ns) {
+  if (ns < PROFILE_SUBBUCKET_NUMS) {
+    return ns;
+  }
+
+  int e = 63 - __builtin_clzll(ns);
+  if (e >= PROFILE_MAX_BITS) {
+    return PROFILE_BUCKET_NUMS - 1;
+  }
+
+  int sub =
+      (ns >> (e - PROFILE_SUBBUCKET_BITS)) & (PROFILE_SUBBUCKET_NUMS - 1);
+
+  return (e - PROFILE_SUBBUCKET_BITS + 1) * PROFILE_SUBBUCKET_NUMS + sub;
+}
+
+// getProfileBucketValue - bucket index -> lowest value(ns) of the bucket
+uint64_t getProfileBucketValue(int bucket) {
+  if (bucket < PROFILE_SUBBUCKET_NUMS) {
+    return bucket;
+  }
+
+  int e = bucket / PROFILE_SUBBUCKET_NUMS + PROFILE_SUBBUCKET_BITS - 1;
+  uint64_t sub = bucket % PROFILE_SUBBUCKET_NUMS;
+
+  return (PROFILE_SUBBUCKET_NUMS + sub) << (e - PROFILE_SUBBUCKET_BITS);
+}
+
+// getProfileStageName - stage name for export
+const char* getProfileStageName(int stage) {
+  if (stage >= 0 && stage < PROFILE_STAGE_NUMS) {
+    return PROFILE_STAGE_NAME[stage];
+  }
+
+  return "unknown";
+}
+
+#ifdef NATASHA_PROFILE
+
+// ProfileThreadData - only the owner thread writes, others only read
+//   写线程只有一个，用 relaxed 的 load/store 就够了，不需要锁
+struct ProfileThreadData {
+  std::atomic<uint64_t> counts[PROFILE_STAGE_NUMS][PROFILE_BUCKET_NUMS];
+  std::atomic<uint64_t> nums[PROFILE_STAGE_NUMS];
+  std::atomic<uint64_t> sum[PROFILE_STAGE_NUMS];
+
+  ProfileThreadData() {
+    for (int s = 0; s < PROFILE_STAGE_NUMS; ++s) {
+      for (int i = 0; i < PROFILE_BUCKET_NUMS; ++i) {
+        counts[s][i].store(0, std::memory_order_relaxed);
+      }
+
+      nums[s].store(0, std::memory_order_relaxed);
+      sum[s].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+static std::atomic<bool> s_profileEnabled(false);
+
+// the data of a finished thread is folded into s_profileRetired and released,
+// so the samples of finished threads are still in the snapshot
+static std::mutex s_profileMutex;
+static std::vector<ProfileThreadData*> s_lstProfileThreadData;
+static ProfileSnapshot s_profileRetired;
+// resetProfile only moves the baseline, writers are never touched
+static ProfileSnapshot s_profileBaseline;
+
+static inline void addProfileValue(std::atomic<uint64_t>& v, uint64_t off) {
+  v.store(v.load(std::memory_order_relaxed) + off, std::memory_order_relaxed);
+}
+
+// addProfileThreadData - snapshot += pData
+static void addProfileThreadData(ProfileSnapshot& snapshot,
+                                 const ProfileThreadData* pData) {
+  for (int s = 0; s < PROFILE_STAGE_NUMS; ++s) {
+    auto& h = snapshot.stages[s];
+
+    for (int i = 0; i < PROFILE_BUCKET_NUMS; ++i) {
+      h.counts[i] += pData->counts[s][i].load(std::memory_order_relaxed);
+    }
+
+    h.nums += pData->nums[s].load(std::memory_order_relaxed);
+    h.sum += pData->sum[s].load(std::memory_order_relaxed);
+  }
+}
+
+// ProfileThreadOwner - owns the data of current thread
+//                    - 线程结束时把数据合并到 s_profileRetired 再释放，
+//                      线程不停创建销毁的服务器不会泄漏
+class ProfileThreadOwner {
+ public:
+  ProfileThreadOwner() : m_pData(NULL) {}
+  ~ProfileThreadOwner() {
+    if (m_pData == NULL) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_profileMutex);
+
+    addProfileThreadData(s_profileRetired, m_pData);
+
+    for (auto it = s_lstProfileThreadData.begin();
+         it != s_lstProfileThreadData.end(); ++it) {
+      if (*it == m_pData) {
+        s_lstProfileThreadData.erase(it);
+
+        break;
+      }
+    }
+
+    delete m_pData;
+  }
+
+  ProfileThreadData* get() {
+    if (m_pData == NULL) {
+      m_pData = new ProfileThreadData();
+
+      std::lock_guard<std::mutex> lock(s_profileMutex);
+      s_lstProfileThreadData.push_back(m_pData);
+    }
+
+    return m_pData;
+  }
+
+ private:
+  ProfileThreadData* m_pData;
+};
+
+static ProfileThreadData* getProfileThreadData() {
+  thread_local ProfileThreadOwner owner;
+
+  return owner.get();
+}
+
+// setProfileEnabled - runtime switch, default is disabled
+void setProfileEnabled(bool enabled) {
+  s_profileEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// isProfileEnabled - runtime switch
+bool isProfileEnabled() {
+  return s_profileEnabled.load(std::memory_order_relaxed);
+}
+
+// getProfileNanoseconds - monotonic clock in ns
+uint64_t getProfileNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// addProfile - record a latency for current thread
+void addProfile(ProfileStage stage, uint64_t ns) {
+  assert(stage >= 0 && stage < PROFILE_STAGE_NUMS);
+
+  auto pData = getProfileThreadData();
+
+  addProfileValue(pData->counts[stage][getProfileBucket(ns)], 1);
+  addProfileValue(pData->nums[stage], 1);
+  addProfileValue(pData->sum[stage], ns);
+}
+
+// mergeProfileSnapshot - retired threads + live threads
+static void mergeProfileSnapshot(ProfileSnapshot& snapshot) {
+  snapshot = s_profileRetired;
+
+  for (auto pData : s_lstProfileThreadData) {
+    addProfileThreadData(snapshot, pData);
+  }
+}
+
+// getProfileSnapshot - merge all threads
+void getProfileSnapshot(ProfileSnapshot& snapshot) {
+  std::lock_guard<std::mutex> lock(s_profileMutex);
+
+  mergeProfileSnapshot(snapshot);
+
+  for (int s = 0; s < PROFILE_STAGE_NUMS; ++s) {
+    auto& h = snapshot.stages[s];
+    auto& b = s_profileBaseline.stages[s];
+
+    for (int i = 0; i < PROFILE_BUCKET_NUMS; ++i) {
+      h.counts[i] -= b.counts[i];
+    }
+
+    h.nums -= b.nums;
+    h.sum -= b.sum;
+  }
+}
+
+// resetProfile - the next snapshot only counts the samples after reset
+void resetProfile() {
+  std::lock_guard<std::mutex> lock(s_profileMutex);
+
+  mergeProfileSnapshot(s_profileBaseline);
+}
+
+// outputProfile - print snapshot
+void outputProfile() {
+  ProfileSnapshot* pSnapshot = new ProfileSnapshot();
+  getProfileSnapshot(*pSnapshot);
+
+  printf("profile(ns) nums mean p50 p90 p99 p999\n");
+
+  for (int s = 0; s < PROFILE_STAGE_NUMS; ++s) {
+    auto& h = pSnapshot->stages[s];
+
+    printf("%s %llu %llu %llu %llu %llu %llu\n", getProfileStageName(s),
+           (unsigned long long)h.nums, (unsigned long long)h.getMean(),
+           (unsigned long long)h.getValueAtPercentile(50),
+           (unsigned long long)h.getValueAtPercentile(90),
+           (unsigned long long)h.getValueAtPercentile(99),
+           (unsigned long long)h.getValueAtPercentile(99.9));
+  }
+
+  delete pSnapshot;
+}
+
+#endif  // NATASHA_PROFILE
+
+}  // namespace natasha
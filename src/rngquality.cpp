@@ -0,0 +1,210 @@
+#include "../include/rngquality.h"
+#include <math.h>
+#include "../include/config.h"
+#include "../include/fortuna.h"
+
+namespace natasha {
+
+// GAMMA_EPS - relative precision of the incomplete gamma function
+const double GAMMA_EPS = 1e-14;
+const int GAMMA_MAX_ITER = 10000;
+
+// lowerGammaSeries - regularized lower incomplete gamma P(a, x), x < a + 1
+static double lowerGammaSeries(double a, double x) {
+  double ap = a;
+  double sum = 1.0 / a;
+  double del = sum;
+
+  for (int i = 0; i < GAMMA_MAX_ITER; ++i) {
+    ap += 1;
+    del *= x / ap;
+    sum += del;
+
+    if (fabs(del) < fabs(sum) * GAMMA_EPS) {
+      break;
+    }
+  }
+
+  return sum * exp(-x + a * log(x) - lgamma(a));
+}
+
+// upperGammaFraction - regularized upper incomplete gamma Q(a, x),
+//                      x >= a + 1, Lentz's continued fraction
+static double upperGammaFraction(double a, double x) {
+  const double TINY = 1e-300;
+
+  double b = x + 1 - a;
+  double c = 1 / TINY;
+  double d = 1 / b;
+  double h = d;
+
+  for (int i = 1; i < GAMMA_MAX_ITER; ++i) {
+    double an = -i * (i - a);
+    b += 2;
+
+    d = an * d + b;
+    if (fabs(d) < TINY) {
+      d = TINY;
+    }
+
+    c = b + an / c;
+    if (fabs(c) < TINY) {
+      c = TINY;
+    }
+
+    d = 1 / d;
+    double del = d * c;
+    h *= del;
+
+    if (fabs(del - 1) < GAMMA_EPS) {
+      break;
+    }
+  }
+
+  return exp(-x + a * log(x) - lgamma(a)) * h;
+}
+
+// chiSquarePValue - upper tail of chi-square with dof degrees of freedom
+double chiSquarePValue(double chi2, int dof) {
+  assert(dof > 0);
+
+  if (chi2 <= 0) {
+    return 1;
+  }
+
+  double a = dof / 2.0;
+  double x = chi2 / 2.0;
+
+  if (x < a + 1) {
+    return 1 - lowerGammaSeries(a, x);
+  }
+
+  return upperGammaFraction(a, x);
+}
+
+// countChiSquare - chi-square of lstCount against lstProb
+bool countChiSquare(const std::vector<int64_t>& lstCount,
+                    const std::vector<double>& lstProb,
+                    ChiSquareResult& result) {
+  if (lstCount.size() != lstProb.size() || lstCount.size() < 2) {
+    return false;
+  }
+
+  result = ChiSquareResult();
+
+  for (size_t i = 0; i < lstCount.size(); ++i) {
+    result.drawNums += lstCount[i];
+  }
+
+  for (size_t i = 0; i < lstCount.size(); ++i) {
+    if (lstProb[i] <= 0) {
+      // 不可能出现的结果出现了
+      if (lstCount[i] > 0) {
+        result.bins = lstCount.size();
+        result.chi2 = INFINITY;
+        result.dof = 1;
+        result.pValue = 0;
+
+        return true;
+      }
+
+      continue;
+    }
+
+    double e = lstProb[i] * result.drawNums;
+    double d = lstCount[i] - e;
+
+    result.chi2 += d * d / e;
+    ++result.bins;
+  }
+
+  if (result.bins < 2) {
+    return false;
+  }
+
+  result.dof = result.bins - 1;
+  result.pValue = chiSquarePValue(result.chi2, result.dof);
+
+  return true;
+}
+
+// testRandomScale - chi-square of drawNums randomScale(max)
+bool testRandomScale(uint32_t max, int64_t drawNums, int maxBins,
+                     ChiSquareResult& result) {
+  if (max < 2 || drawNums <= 0 || maxBins < 2) {
+    return false;
+  }
+
+  int bins = max < (uint32_t)maxBins ? max : maxBins;
+
+  // bin 是 v * bins / max，每格的整数个数是 ceil((b + 1) * max / bins) -
+  // ceil(b * max / bins)
+  std::vector<double> lstProb(bins);
+  for (int b = 0; b < bins; ++b) {
+    uint64_t begin = ((uint64_t)b * max + bins - 1) / bins;
+    uint64_t end = ((uint64_t)(b + 1) * max + bins - 1) / bins;
+
+    lstProb[b] = (double)(end - begin) / max;
+  }
+
+  std::vector<int64_t> lstCount(bins, 0);
+  for (int64_t i = 0; i < drawNums; ++i) {
+    uint32_t v = randomScale(max);
+    if (v >= max) {
+      return false;
+    }
+
+    ++lstCount[(uint64_t)v * bins / max];
+  }
+
+  return countChiSquare(lstCount, lstProb, result);
+}
+
+// getWeightProb - probabilities of the weights of cfg
+static std::vector<double> getWeightProb(
+    const ::natashapb::WeightConfig& cfg) {
+  std::vector<double> lstProb(cfg.weights_size());
+  for (int i = 0; i < cfg.weights_size(); ++i) {
+    lstProb[i] = (double)cfg.weights(i) / cfg.totalweight();
+  }
+
+  return lstProb;
+}
+
+// testRandWeightConfig - chi-square of drawNums randWeightConfig
+bool testRandWeightConfig(const ::natashapb::WeightConfig& cfg,
+                          int64_t drawNums, ChiSquareResult& result) {
+  if (!isValidWeightConfig(cfg) || drawNums <= 0) {
+    return false;
+  }
+
+  std::vector<int64_t> lstCount(cfg.weights_size(), 0);
+  for (int64_t i = 0; i < drawNums; ++i) {
+    int v = randWeightConfig(cfg);
+    if (v < 0 || v >= cfg.weights_size()) {
+      return false;
+    }
+
+    ++lstCount[v];
+  }
+
+  return countChiSquare(lstCount, getWeightProb(cfg), result);
+}
+
+// testRandAliasTable - chi-square of drawNums randAliasTable
+bool testRandAliasTable(const ::natashapb::WeightConfig& cfg,
+                        int64_t drawNums, ChiSquareResult& result) {
+  AliasTable table;
+  if (!compileAliasTable(cfg, table) || drawNums <= 0) {
+    return false;
+  }
+
+  std::vector<int64_t> lstCount(cfg.weights_size(), 0);
+  for (int64_t i = 0; i < drawNums; ++i) {
+    ++lstCount[randAliasTable(table)];
+  }
+
+  return countChiSquare(lstCount, getWeightProb(cfg), result);
+}
+
+}  // namespace natasha
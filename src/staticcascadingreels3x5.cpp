@@ -9,12 +9,19 @@ void StaticCascadingReels3X5::randomNew(
   uint32_t cr = randomScale(m_lst.size());
   assert(cr >= 0 && cr < m_lst.size());
 
-  SymbolBlockData* pSBD = m_lst[cr];
+  newWithIndex(pSCRR, cr);
+}
+
+void StaticCascadingReels3X5::newWithIndex(
+    ::natashapb::StaticCascadingRandomResult3X5* pSCRR, int index) {
+  assert(index >= 0 && index < m_lst.size());
+
+  SymbolBlockData* pSBD = m_lst[index];
   assert(pSBD->size() > 0);
 
   // printSymbolBlock3X5("randomNew", pSBD->at(0), SYMBOL_MAPPING);
 
-  pSCRR->set_reelsindex(cr);
+  pSCRR->set_reelsindex(index);
   pSCRR->set_downnums(0);
 
   ::natashapb::SymbolBlock* pSB = pSCRR->mutable_symbolblock();
@@ -91,6 +98,13 @@ void StaticCascadingReels3X5::random(
   }
 }
 
+void StaticCascadingReels3X5::randomWithIndex(
+    ::natashapb::RandomResult* pRandomResult, int index) {
+  assert(pRandomResult != NULL);
+
+  newWithIndex(pRandomResult->mutable_scrr3x5(), index);
+}
+
 void StaticCascadingReels3X5::clear() {
   for (int i = 0; i < m_lst.size(); ++i) {
     SymbolBlockData* pSBD = m_lst[i];
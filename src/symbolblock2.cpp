@@ -134,30 +134,7 @@ void buildSymbolLine3X5(const ::natashapb::SymbolBlock3X5* pSB,
 void cascadeBlock3X5(::natashapb::SymbolBlock3X5* pSB) {
   assert(pSB != NULL);
 
-  for (int xx = 0; xx < 5; ++xx) {
-    if (getSymbolBlock3X5(pSB, xx, 2) < 0) {
-      if (getSymbolBlock3X5(pSB, xx, 1) < 0) {
-        if (getSymbolBlock3X5(pSB, xx, 0) >= 0) {
-          setSymbolBlock3X5(pSB, xx, 2, getSymbolBlock3X5(pSB, xx, 0));
-          setSymbolBlock3X5(pSB, xx, 0, -1);
-        }
-      } else {
-        if (getSymbolBlock3X5(pSB, xx, 0) >= 0) {
-          setSymbolBlock3X5(pSB, xx, 2, getSymbolBlock3X5(pSB, xx, 1));
-          setSymbolBlock3X5(pSB, xx, 1, getSymbolBlock3X5(pSB, xx, 0));
-          setSymbolBlock3X5(pSB, xx, 0, -1);
-        } else {
-          setSymbolBlock3X5(pSB, xx, 2, getSymbolBlock3X5(pSB, xx, 1));
-          setSymbolBlock3X5(pSB, xx, 1, -1);
-        }
-      }
-    } else if (getSymbolBlock3X5(pSB, xx, 1) < 0) {
-      if (getSymbolBlock3X5(pSB, xx, 0) >= 0) {
-        setSymbolBlock3X5(pSB, xx, 1, getSymbolBlock3X5(pSB, xx, 0));
-        setSymbolBlock3X5(pSB, xx, 0, -1);
-      }
-    }
-  }
+  cascadeBlock<::natashapb::SymbolBlock3X5, 5, 3>(pSB);
 }
 
 // removeBlock3X5WithGameResult - remove all symbol in gameresult
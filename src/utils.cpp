@@ -16,6 +16,23 @@ void clearGameResultInfo(::natashapb::GameResultInfo& gri) {
 // clearSpinResult
 void clearSpinResult(::natashapb::SpinResult& sr) { sr.Clear(); }
 
+// applyBetToGameResult - win = mul * bet for lstgri[begin, end)
+MoneyType applyBetToGameResult(::natashapb::SpinResult& sr, int begin,
+                               MoneyType bet) {
+  MoneyType totalwin = 0;
+
+  for (int i = begin; i < sr.lstgri_size(); ++i) {
+    auto pGRI = sr.mutable_lstgri(i);
+
+    pGRI->set_win(bet * pGRI->mul());
+    pGRI->set_realwin(pGRI->win());
+
+    totalwin += pGRI->win();
+  }
+
+  return totalwin;
+}
+
 // setGameCtrlID
 void setGameCtrlID(::natashapb::GameCtrlID& dest,
                    const ::natashapb::GameCtrlID& parent, CtrlID curCtrlID,
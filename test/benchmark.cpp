@@ -0,0 +1,746 @@
+#include <benchmark/benchmark.h>
+#include <stdio.h>
+#include "../include/fortuna.h"
+#include "../include/symbolblock2.h"
+#include "../museum/museum.h"
+#include "../tlod/tlod.h"
+
+extern "C" {
+#include "../libfortuna/sha2.h"
+}
+
+// 所有 benchmark 都用固定的 seed 和固定的盘面，这样不同提交之间的结果才可以比较
+
+namespace {
+
+const uint64_t BENCHMARK_SEED = 20180808;
+
+const int BENCHMARK_BOARDS = 64;
+
+const int BENCHMARK_REELS_LENGTH = 64;
+
+// getTLOD - TLOD for benchmark, init once, NULL if init fail
+natasha::TLOD* getTLOD() {
+  static natasha::TLOD* pTLOD = NULL;
+  static bool isInited = false;
+  if (!isInited) {
+    isInited = true;
+
+    natasha::resetRandomSeed(BENCHMARK_SEED);
+
+    pTLOD = new natasha::TLOD();
+    auto code = pTLOD->init("./csv");
+    if (code != ::natashapb::OK) {
+      printf("TLOD init fail(%d)!\n", code);
+
+      delete pTLOD;
+      pTLOD = NULL;
+    }
+  }
+
+  return pTLOD;
+}
+
+// getBoards - the first symbol block of the first BENCHMARK_BOARDS TLOD
+//             scenarios, empty if TLOD init fail
+const std::vector< ::natashapb::SymbolBlock3X5>& getBoards() {
+  static std::vector< ::natashapb::SymbolBlock3X5> lst;
+  auto pTLOD = getTLOD();
+  if (lst.empty() && pTLOD != NULL) {
+    auto& reels = pTLOD->getReels();
+
+    for (int i = 0; i < BENCHMARK_BOARDS && i < reels.getLength(); ++i) {
+      lst.push_back(*(reels.getNode(0, i)));
+    }
+  }
+
+  return lst;
+}
+
+// getReels - fixed normal reels, independent of csv
+const natasha::NormalReels3X5& getReels() {
+  static natasha::NormalReels3X5 reels;
+  if (reels.isEmpty()) {
+    for (int x = 0; x < 5; ++x) {
+      reels.resetReelsLength(x, BENCHMARK_REELS_LENGTH + x);
+
+      for (int y = 0; y < BENCHMARK_REELS_LENGTH + x; ++y) {
+        reels.setReels(x, y, (y * 7 + x * 3) % natasha::MeseumMaxSymbols);
+      }
+    }
+  }
+
+  return reels;
+}
+
+// getWaysPaytables - fixed ways paytables, independent of csv
+const natasha::Paytables3X5& getWaysPaytables() {
+  static natasha::Paytables3X5 paytables;
+  if (paytables.isEmpty()) {
+    for (natasha::SymbolType s = 1; s < natasha::MUSEUM_SYMBOL_S; ++s) {
+      paytables.setSymbolPayout(s, 0, 0);
+      paytables.setSymbolPayout(s, 1, 0);
+      paytables.setSymbolPayout(s, 2, 5 + s);
+      paytables.setSymbolPayout(s, 3, 10 + s * 2);
+      paytables.setSymbolPayout(s, 4, 20 + s * 5);
+    }
+
+    paytables.setSymbolPayout(natasha::MUSEUM_SYMBOL_S, 0, 0);
+    paytables.setSymbolPayout(natasha::MUSEUM_SYMBOL_S, 1, 0);
+    paytables.setSymbolPayout(natasha::MUSEUM_SYMBOL_S, 2, 1);
+    paytables.setSymbolPayout(natasha::MUSEUM_SYMBOL_S, 3, 5);
+    paytables.setSymbolPayout(natasha::MUSEUM_SYMBOL_S, 4, 20);
+  }
+
+  return paytables;
+}
+
+// getWaysBoards - boards from the fixed normal reels, with some wilds
+const std::vector< ::natashapb::SymbolBlock3X5>& getWaysBoards() {
+  static std::vector< ::natashapb::SymbolBlock3X5> lst;
+  if (lst.empty()) {
+    auto& reels = getReels();
+
+    for (int i = 0; i < BENCHMARK_BOARDS; ++i) {
+      ::natashapb::SymbolBlock3X5 sb;
+
+      for (int x = 0; x < 5; ++x) {
+        for (int y = 0; y < 3; ++y) {
+          int ry = (i * (x + 1) + y) % reels.getReelsLength(x);
+          natasha::SymbolType s = reels.getSymbol(x, ry);
+          if (x > 0 && (i + x * 3 + y) % 11 == 0) {
+            s = natasha::MUSEUM_SYMBOL_W;
+          }
+
+          natasha::setSymbolBlock3X5(&sb, x, y, s);
+        }
+      }
+
+      lst.push_back(sb);
+    }
+  }
+
+  return lst;
+}
+
+// getHoleBoards - boards with removed symbols, for cascade and fill
+const std::vector< ::natashapb::SymbolBlock3X5>& getHoleBoards() {
+  static std::vector< ::natashapb::SymbolBlock3X5> lst;
+  if (lst.empty()) {
+    auto& boards = getBoards();
+
+    for (int i = 0; i < (int)boards.size(); ++i) {
+      ::natashapb::SymbolBlock3X5 sb(boards[i]);
+
+      for (int x = 0; x < 5; ++x) {
+        for (int y = 0; y < 3; ++y) {
+          if ((i + x * 3 + y * 5) % 4 == 0) {
+            natasha::setSymbolBlock3X5(&sb, x, y, -1);
+          }
+        }
+      }
+
+      lst.push_back(sb);
+    }
+  }
+
+  return lst;
+}
+
+// getWeightConfig - fixed weight config
+const ::natashapb::WeightConfig& getWeightConfig() {
+  static ::natashapb::WeightConfig cfg;
+  if (cfg.weights_size() == 0) {
+    cfg.add_weights(1);
+    cfg.add_weights(185);
+    cfg.add_weights(15);
+    cfg.add_weights(12);
+    cfg.add_weights(75);
+    cfg.add_weights(100);
+    cfg.set_totalweight(natasha::sumWeightConfig(cfg));
+  }
+
+  return cfg;
+}
+
+}  // namespace
+
+static void BM_getSymbolBlock3X5(benchmark::State& state) {
+  auto& boards = getBoards();
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  for (auto _ : state) {
+    auto& sb = boards[i++ % boards.size()];
+    natasha::SymbolType sum = 0;
+
+    for (int y = 0; y < 3; ++y) {
+      for (int x = 0; x < 5; ++x) {
+        sum += natasha::getSymbolBlock3X5(&sb, x, y);
+      }
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_getSymbolBlock3X5);
+
+static void BM_randomNewReels3x5(benchmark::State& state) {
+  auto& reels = getReels();
+  ::natashapb::NormalReelsRandomResult3X5 nrrr;
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    natasha::_randomNewReels3x5(reels, &nrrr);
+
+    benchmark::DoNotOptimize(nrrr.symbolblock().sb3x5().dat0_0());
+  }
+}
+BENCHMARK(BM_randomNewReels3x5);
+
+static void BM_fillReels3x5(benchmark::State& state) {
+  auto& reels = getReels();
+  auto& boards = getHoleBoards();
+  ::natashapb::NormalReelsRandomResult3X5 nrrr;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::FuncOnFillReels f = [](int x, int y, natasha::SymbolType s) {
+    return s;
+  };
+
+  for (auto _ : state) {
+    for (int x = 0; x < 5; ++x) {
+      nrrr.add_reelsindex(i % reels.getReelsLength(x));
+    }
+
+    natasha::_fillReels3x5(reels, boards[i++ % boards.size()], &nrrr, f);
+
+    benchmark::DoNotOptimize(nrrr.symbolblock().sb3x5().dat0_0());
+
+    nrrr.clear_reelsindex();
+  }
+}
+BENCHMARK(BM_fillReels3x5);
+
+static void BM_fillReels3x5T(benchmark::State& state) {
+  auto& reels = getReels();
+  auto& boards = getHoleBoards();
+  ::natashapb::NormalReelsRandomResult3X5 nrrr;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    for (int x = 0; x < 5; ++x) {
+      nrrr.add_reelsindex(i % reels.getReelsLength(x));
+    }
+
+    natasha::fillReels3x5T(reels, boards[i++ % boards.size()], &nrrr,
+                           natasha::FillIdentity());
+
+    benchmark::DoNotOptimize(nrrr.symbolblock().sb3x5().dat0_0());
+
+    nrrr.clear_reelsindex();
+  }
+}
+BENCHMARK(BM_fillReels3x5T);
+
+// getMysteryWild - fixed mystery wild weight
+const natasha::WeightTable& getMysteryWild() {
+  static natasha::WeightTable table;
+  if (table.lstWeight.empty()) {
+    table.lstWeight.push_back(1);
+    table.lstWeight.push_back(20);
+    table.totalWeight = 21;
+  }
+
+  return table;
+}
+
+static void BM_fillReels3x5_MysteryWild(benchmark::State& state) {
+  auto& reels = getReels();
+  auto& boards = getHoleBoards();
+  ::natashapb::NormalReelsRandomResult3X5 nrrr;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::MuseumMysteryWildFill policy(getMysteryWild());
+
+  for (auto _ : state) {
+    for (int x = 0; x < 5; ++x) {
+      nrrr.add_reelsindex(i % reels.getReelsLength(x));
+    }
+
+    if (state.range(0) == 0) {
+      natasha::fillReels3x5T(reels, boards[i++ % boards.size()], &nrrr,
+                             policy);
+    } else {
+      natasha::fillReels3x5Batch(reels, boards[i++ % boards.size()], &nrrr,
+                                 policy);
+    }
+
+    benchmark::DoNotOptimize(nrrr.symbolblock().sb3x5().dat0_0());
+
+    nrrr.clear_reelsindex();
+  }
+}
+BENCHMARK(BM_fillReels3x5_MysteryWild)->Arg(0)->Arg(1);
+
+static void BM_countFullWays5_Left(benchmark::State& state) {
+  auto& boards = getWaysBoards();
+  auto& paytables = getWaysPaytables();
+  ::natashapb::SpinResult sr;
+  int i = 0;
+
+  for (auto _ : state) {
+    sr.Clear();
+
+    natasha::MuseumCountWays(sr, boards[i++ % boards.size()], paytables, 1);
+
+    benchmark::DoNotOptimize(sr.win());
+  }
+}
+BENCHMARK(BM_countFullWays5_Left);
+
+// BM_countFullWays5_Left_Cache - Arg(0) is without cache, Arg(1) hits the
+//                                cache after the first BENCHMARK_BOARDS
+static void BM_countFullWays5_Left_Cache(benchmark::State& state) {
+  auto& boards = getWaysBoards();
+  auto& paytables = getWaysPaytables();
+  natasha::BoardResultCache3X5 cache(BENCHMARK_BOARDS);
+  auto pCache = state.range(0) ? &cache : NULL;
+  ::natashapb::SpinResult sr;
+  int i = 0;
+
+  for (auto _ : state) {
+    sr.Clear();
+
+    natasha::MuseumCountWaysCache(sr, boards[i++ % boards.size()], paytables,
+                                  1, pCache);
+
+    benchmark::DoNotOptimize(sr.win());
+  }
+}
+BENCHMARK(BM_countFullWays5_Left_Cache)->Arg(0)->Arg(1);
+
+static void BM_countAllLine_Left(benchmark::State& state) {
+  auto pTLOD = getTLOD();
+  auto& boards = getBoards();
+  ::natashapb::SpinResult sr;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  for (auto _ : state) {
+    sr.Clear();
+
+    natasha::TLODCountAllLine(sr, boards[i++ % boards.size()],
+                              pTLOD->getLines(), pTLOD->getPaytables(), 1);
+
+    benchmark::DoNotOptimize(sr.win());
+  }
+}
+BENCHMARK(BM_countAllLine_Left);
+
+static void BM_countScatter_Left(benchmark::State& state) {
+  auto pTLOD = getTLOD();
+  auto& boards = getBoards();
+  ::natashapb::GameResultInfo gri;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  for (auto _ : state) {
+    auto iswin = natasha::TLODCountScatter(
+        gri, boards[i++ % boards.size()], pTLOD->getPaytables(),
+        natasha::TLOD_SYMBOL_S, natasha::TLOD_DEFAULT_PAY_LINES);
+
+    benchmark::DoNotOptimize(iswin);
+  }
+}
+BENCHMARK(BM_countScatter_Left);
+
+// BM_countScatter_Left_Mask - build the masks of the board and count scatter
+static void BM_countScatter_Left_Mask(benchmark::State& state) {
+  auto pTLOD = getTLOD();
+  auto& boards = getBoards();
+  ::natashapb::GameResultInfo gri;
+  natasha::TLODSymbolMask masks;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  for (auto _ : state) {
+    masks.build(boards[i++ % boards.size()]);
+
+    auto iswin = natasha::TLODCountScatterMask(
+        gri, masks, pTLOD->getPaytables(), natasha::TLOD_SYMBOL_S,
+        natasha::TLOD_DEFAULT_PAY_LINES);
+
+    benchmark::DoNotOptimize(iswin);
+  }
+}
+BENCHMARK(BM_countScatter_Left_Mask);
+
+static void BM_cascadeBlock3X5(benchmark::State& state) {
+  auto& boards = getHoleBoards();
+  ::natashapb::SymbolBlock3X5 sb;
+  int i = 0;
+
+  if (boards.empty()) {
+    state.SkipWithError("TLOD init fail, no boards");
+    return;
+  }
+
+  for (auto _ : state) {
+    sb.CopyFrom(boards[i++ % boards.size()]);
+
+    natasha::cascadeBlock3X5(&sb);
+
+    benchmark::DoNotOptimize(sb.dat2_0());
+  }
+}
+BENCHMARK(BM_cascadeBlock3X5);
+
+static void BM_randWeightConfig(benchmark::State& state) {
+  auto& cfg = getWeightConfig();
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(natasha::randWeightConfig(cfg));
+  }
+}
+BENCHMARK(BM_randWeightConfig);
+
+static void BM_randAliasTable(benchmark::State& state) {
+  natasha::AliasTable table;
+  natasha::compileAliasTable(getWeightConfig(), table);
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(natasha::randAliasTable(table));
+  }
+}
+BENCHMARK(BM_randAliasTable);
+
+static void BM_randomScale(benchmark::State& state) {
+  uint32_t max = state.range(0);
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(natasha::randomScale(max));
+  }
+}
+BENCHMARK(BM_randomScale)->Arg(6)->Arg(1000)->Arg(3000000000u);
+
+// BM_randomScaleArray - 15 numbers, one for each cell of 3x5
+static void BM_randomScaleArray(benchmark::State& state) {
+  uint32_t lst[15];
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  for (auto _ : state) {
+    natasha::randomScaleArray(lst, 15, 21);
+
+    benchmark::DoNotOptimize(lst[0]);
+  }
+}
+BENCHMARK(BM_randomScaleArray);
+
+// BM_SHA256 - one fortuna add_entropy, Arg(0) is portable, Arg(1) is sha-ni
+static void BM_SHA256(benchmark::State& state) {
+  uint8 data[32] = {0};
+  uint8 digest[SHA256_DIGEST_LENGTH];
+
+  if (SHA256_SetAccel(state.range(0)) != state.range(0)) {
+    state.SkipWithError("no sha-ni");
+    return;
+  }
+
+  for (auto _ : state) {
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+    SHA256_Update(&ctx, data, sizeof(data));
+    SHA256_Final(digest, &ctx);
+
+    data[0] = digest[0];
+  }
+
+  SHA256_SetAccel(1);
+}
+BENCHMARK(BM_SHA256)->Arg(0)->Arg(1);
+
+// BM_gameCtrl_TLOD - Arg(0) is without lines cache, Arg(1) with it
+static void BM_gameCtrl_TLOD(benchmark::State& state) {
+  auto pTLOD = getTLOD();
+  if (pTLOD == NULL) {
+    state.SkipWithError("TLOD init fail");
+    return;
+  }
+
+  auto& tlod = *pTLOD;
+
+  // TLOD 的 scenario 和 cascade 一共只有 1400 多个盘面
+  tlod.enableLinesCache(state.range(0) ? 4096 : 0);
+
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::UserInfo user;
+  ::natashapb::UserGameLogicInfo ugi;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = NULL;
+
+  tlod.userComeIn(&user);
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl fg;
+  fg.mutable_freespin()->set_bet(1);
+  fg.mutable_freespin()->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+  fg.mutable_freespin()->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+  int64_t ctrlid = 1;
+
+  for (auto _ : state) {
+    auto pGameCtrl =
+        ugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(ctrlid++);
+
+    auto code = tlod.gameCtrl(pGameCtrl, &user);
+    if (code != ::natashapb::OK) {
+      state.SkipWithError("TLOD gameCtrl fail");
+      break;
+    }
+  }
+
+  auto pCache = tlod.getLinesCache();
+  if (pCache != NULL) {
+    state.counters["hitrate"] =
+        (double)pCache->getHitNums() /
+        (pCache->getHitNums() + pCache->getMissNums());
+  }
+
+  tlod.enableLinesCache(0);
+}
+BENCHMARK(BM_gameCtrl_TLOD)->Arg(0)->Arg(1);
+
+static void BM_gameCtrl_Museum(benchmark::State& state) {
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::Museum museum;
+  auto code = museum.init("./csv");
+  if (code != ::natashapb::OK) {
+    state.SkipWithError("Museum init fail, need ./csv/game462_*.csv");
+    return;
+  }
+
+  natasha::UserInfo user;
+  ::natashapb::UserGameLogicInfo ugi;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)museum.getGameConfig("rtp96");
+
+  ugi.set_configname("rtp96");
+  museum.userComeIn(&user);
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl fg;
+  fg.mutable_freespin()->set_bet(1);
+  fg.mutable_freespin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  fg.mutable_freespin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  int64_t ctrlid = 1;
+
+  for (auto _ : state) {
+    auto pGameCtrl =
+        ugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(ctrlid++);
+
+    code = museum.gameCtrl(pGameCtrl, &user);
+    if (code != ::natashapb::OK) {
+      state.SkipWithError("Museum gameCtrl fail");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_gameCtrl_Museum);
+
+// REPLAY_ROUNDS - gamectrls recorded for BM_replayGameCtrl_Museum
+const int REPLAY_ROUNDS = 4096;
+
+// BM_replayGameCtrl_Museum - Arg(0) gameCtrlWithJournal, Arg(1) replayGameCtrl
+//                            of the recorded journals
+//                          - 回放完 REPLAY_ROUNDS 局以后用户恢复到开始时
+static void BM_replayGameCtrl_Museum(benchmark::State& state) {
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::Museum museum;
+  auto code = museum.init("./csv");
+  if (code != ::natashapb::OK) {
+    state.SkipWithError("Museum init fail, need ./csv/game462_*.csv");
+    return;
+  }
+
+  natasha::UserInfo user;
+  ::natashapb::UserGameLogicInfo ugi;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)museum.getGameConfig("rtp96");
+
+  ugi.set_configname("rtp96");
+  museum.userComeIn(&user);
+
+  ::natashapb::UserGameLogicInfo startugi;
+  startugi.CopyFrom(ugi);
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl fg;
+  fg.mutable_freespin()->set_bet(1);
+  fg.mutable_freespin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  fg.mutable_freespin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  std::vector<std::string> lstJournal;
+  natasha::RandomJournal journal;
+  int64_t journalBytes = 0;
+
+  for (int i = 0; i < REPLAY_ROUNDS; ++i) {
+    auto pGameCtrl =
+        ugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(i + 1);
+
+    code = museum.gameCtrlWithJournal(pGameCtrl, &user, journal);
+    if (code != ::natashapb::OK) {
+      state.SkipWithError("Museum gameCtrlWithJournal fail");
+      return;
+    }
+
+    lstJournal.push_back(journal.getData());
+    journalBytes += journal.getData().size();
+  }
+
+  ugi.CopyFrom(startugi);
+
+  bool isReplay = state.range(0) != 0;
+  int round = 0;
+
+  for (auto _ : state) {
+    if (round == REPLAY_ROUNDS) {
+      ugi.CopyFrom(startugi);
+      round = 0;
+    }
+
+    auto pGameCtrl =
+        ugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(round + 1);
+
+    if (isReplay) {
+      natasha::RandomReplay replay(lstJournal[round]);
+
+      code = museum.replayGameCtrl(pGameCtrl, &user, replay);
+      if (code != ::natashapb::OK || !replay.isFinished()) {
+        state.SkipWithError("Museum replayGameCtrl fail");
+        break;
+      }
+    } else {
+      code = museum.gameCtrlWithJournal(pGameCtrl, &user, journal);
+      if (code != ::natashapb::OK) {
+        state.SkipWithError("Museum gameCtrlWithJournal fail");
+        break;
+      }
+    }
+
+    ++round;
+  }
+
+  state.counters["bytes"] = (double)journalBytes / REPLAY_ROUNDS;
+}
+BENCHMARK(BM_replayGameCtrl_Museum)->Arg(0)->Arg(1);
+
+// BM_resolveGameCtrl_Museum - one iteration is one paid spin, resolved to the
+//                             end of cascades & free spins
+static void BM_resolveGameCtrl_Museum(benchmark::State& state) {
+  natasha::resetRandomSeed(BENCHMARK_SEED);
+
+  natasha::Museum museum;
+  auto code = museum.init("./csv");
+  if (code != ::natashapb::OK) {
+    state.SkipWithError("Museum init fail, need ./csv/game462_*.csv");
+    return;
+  }
+
+  natasha::UserInfo user;
+  ::natashapb::UserGameLogicInfo ugi;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)museum.getGameConfig("rtp96");
+
+  ugi.set_configname("rtp96");
+  museum.userComeIn(&user);
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  natasha::ResolvedStepList lstStep;
+  int64_t ctrlid = 1;
+
+  for (auto _ : state) {
+    lstStep.clear();
+    bg.set_ctrlid(ctrlid);
+
+    code = museum.resolveGameCtrl(&bg, &user, lstStep, NULL);
+    if (code != ::natashapb::OK) {
+      state.SkipWithError("Museum resolveGameCtrl fail");
+      break;
+    }
+
+    ctrlid += lstStep.size();
+  }
+}
+BENCHMARK(BM_resolveGameCtrl_Museum);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,1115 @@
+#include <google/protobuf/util/message_differencer.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include "../include/fortuna.h"
+#include "../include/randomshards.h"
+#include "../include/rngquality.h"
+#include "../museum/museum.h"
+#include "../museum/museumtuning.h"
+#include "../tlod/tlod.h"
+#include "../tlod/tlodexact.h"
+
+extern "C" {
+#include "../libfortuna/sha2.h"
+}
+
+// natashacheck - seeded checks of the rtp tools, run by ctest
+//   TLOD 的配置是编译进去的，不需要 ./csv
+//   Museum 用 argv[1] 的 csv 目录，ctest 用的是 test/csv，
+//   那是测试用的小配置，不是正式的 game462 配置
+
+namespace {
+
+const int CHECK_SPINNUMS = 500000;
+
+// CHECK_SIGMA - tolerance in standard errors
+const double CHECK_SIGMA = 4;
+
+int s_failNums = 0;
+
+void check(bool ok, const char* name) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+
+  if (!ok) {
+    ++s_failNums;
+  }
+}
+
+// MonteCarloResult - rtp of paid spins, in totalbet
+struct MonteCarloResult {
+  int64_t spinNums;
+  int64_t stepNums;
+  int64_t totalRealWin;
+  double totalWin;
+  double totalWin2;
+
+  double getRTP() const { return totalWin / spinNums; }
+
+  // getStdError - standard error of getRTP
+  double getStdError() const {
+    double mean = getRTP();
+    return sqrt((totalWin2 / spinNums - mean * mean) / spinNums);
+  }
+};
+
+// runMonteCarlo_tlod - seeded paid spins, resolved to the end of free game
+::natashapb::CODE runMonteCarlo_tlod(natasha::TLOD& tlod, uint64_t seed,
+                                     int spinNums, MonteCarloResult& result) {
+  natasha::setThreadRandomSeed(seed);
+
+  ::natashapb::UserGameLogicInfo ugi;
+  natasha::UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = NULL;
+
+  auto code = tlod.userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::GameCtrl gamectrl;
+  auto spin = gamectrl.mutable_spin();
+  spin->set_bet(1);
+  spin->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+  spin->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+  result.spinNums = 0;
+  result.stepNums = 0;
+  result.totalRealWin = 0;
+  result.totalWin = 0;
+  result.totalWin2 = 0;
+
+  natasha::ResolvedStepList lstStep;
+  natasha::CtrlID ctrlid = 1;
+
+  for (int i = 0; i < spinNums; ++i) {
+    lstStep.clear();
+    gamectrl.set_ctrlid(ctrlid);
+
+    code = tlod.resolveGameCtrl(&gamectrl, &user, lstStep, NULL);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    natasha::MoneyType realWin = 0;
+    for (auto& rs : lstStep) {
+      realWin += rs.step.realWin;
+    }
+
+    double win = (double)realWin / natasha::TLOD_DEFAULT_PAY_LINES;
+
+    ctrlid += lstStep.size();
+    result.spinNums++;
+    result.stepNums += lstStep.size();
+    result.totalRealWin += realWin;
+    result.totalWin += win;
+    result.totalWin2 += win * win;
+  }
+
+  natasha::clearThreadRandomSeed();
+
+  return ::natashapb::OK;
+}
+
+// isExactAliasTable - the weights in table are lstWeight * weights
+//                   - 把每格拆回去，和 weight 比较，没有误差
+bool isExactAliasTable(const std::vector<int>& lstWeight) {
+  natasha::AliasTable table;
+  if (!natasha::buildAliasTable(lstWeight, table)) {
+    return false;
+  }
+
+  int64_t n = lstWeight.size();
+  std::vector<int64_t> lstSum(n, 0);
+
+  for (int i = 0; i < n; ++i) {
+    lstSum[i] += table.lstProb[i];
+    lstSum[table.lstAlias[i]] += table.totalWeight - table.lstProb[i];
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (lstSum[i] != lstWeight[i] * n) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// isSameReelsSetSymbol - all the symbols of board are the symbol of reels ri
+//   reelsset_a.csv 全是 1，reelsset_b.csv 全是 2
+bool isSameReelsSetSymbol(const ::natashapb::RandomResult& rr, int ri) {
+  auto& sb = rr.nrrr3x5().symbolblock().sb3x5();
+
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 5; ++x) {
+      if (natasha::getSymbolBlock3X5(&sb, x, y) != ri + 1) {
+        return false;
+      }
+    }
+  }
+
+  return rr.nrrr3x5().reelsindex_size() == 5;
+}
+
+// checkReelsSet - the reels is chosen by weight, the cascade refills with
+//                 the same reels, seeded
+//   返回选到 reelsset_b 的比例，出错返回 -1
+double checkReelsSet(const natasha::NormalReelsSet3X5& set, int spinNums) {
+  natasha::FuncOnFillReels onfill = [](int x, int y, natasha::SymbolType s) {
+    return s;
+  };
+
+  natasha::setThreadRandomSeed(20181010);
+
+  int bNums = 0;
+  bool ok = true;
+  for (int i = 0; i < spinNums && ok; ++i) {
+    ::natashapb::RandomResult rr;
+    ::natashapb::UserGameModInfo ugmi;
+
+    ugmi.mutable_cascadinginfo()->set_isend(true);
+    natasha::randomReels3x5(set, &rr, &ugmi, onfill);
+
+    int ri = natasha::getReelsSetIndex3x5(rr);
+    ok = (ri == 0 || ri == 1) && isSameReelsSetSymbol(rr, ri);
+    if (ri == 1) {
+      ++bNums;
+    }
+
+    // the top row is removed, refill it
+    auto pSB = ugmi.mutable_symbolblock()->mutable_sb3x5();
+    pSB->CopyFrom(rr.nrrr3x5().symbolblock().sb3x5());
+    for (int x = 0; x < 5; ++x) {
+      natasha::setSymbolBlock3X5(pSB, x, 0, -1);
+    }
+
+    ugmi.mutable_cascadinginfo()->set_isend(false);
+    ok = ok && natasha::_getFillReels3x5(set.getReels(ri), &rr, &ugmi) != NULL;
+
+    natasha::randomReels3x5(set, &rr, &ugmi, onfill);
+    ok = ok && natasha::getReelsSetIndex3x5(rr) == ri &&
+         isSameReelsSetSymbol(rr, ri);
+  }
+
+  natasha::clearThreadRandomSeed();
+
+  return ok ? (double)bNums / spinNums : -1;
+}
+
+// sha256Hex - hex digest of data, hashed with updates of step bytes
+std::string sha256Hex(const std::string& data, size_t step) {
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+
+  for (size_t i = 0; i < data.size(); i += step) {
+    size_t len = std::min(step, data.size() - i);
+    SHA256_Update(&ctx, (const uint8*)data.data() + i, len);
+  }
+
+  uint8 digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &ctx);
+
+  char str[SHA256_DIGEST_LENGTH * 2 + 1];
+  for (int i = 0; i < SHA256_DIGEST_LENGTH; ++i) {
+    sprintf(str + i * 2, "%02x", digest[i]);
+  }
+
+  return str;
+}
+
+// isSHA256KnownAnswer - FIPS 180-2 vectors, with the current backend
+bool isSHA256KnownAnswer() {
+  const std::string abc = "abc";
+  const std::string abc448 =
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  const std::string a1m(1000000, 'a');
+
+  return sha256Hex("", 64) ==
+             "e3b0c44298fc1c149afbf4c8996fb924"
+             "27ae41e4649b934ca495991b7852b855" &&
+         sha256Hex(abc, 64) ==
+             "ba7816bf8f01cfea414140de5dae2223"
+             "b00361a396177a9cb410ff61f20015ad" &&
+         sha256Hex(abc448, 7) ==
+             "248d6a61d20638b8e5c026930c3e6039"
+             "a33ce45964ff2167f6ecedd419db06c1" &&
+         sha256Hex(a1m, 1000) ==
+             "cdc76e5c9914fb9281a1c7e284d73e67"
+             "f1809a48a497200e046d39ccc7112cd0";
+}
+
+// isSHA256AccelSame - the SHA extensions and the portable transform give the
+//                     same digests, true if the cpu has no SHA extensions
+bool isSHA256AccelSame() {
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data.push_back((char)(i * 131 + 7));
+  }
+
+  bool same = true;
+  for (size_t len = 0; len <= data.size() && same; len += 37) {
+    for (size_t step : {1, 63, 64, 200}) {
+      std::string cur = data.substr(0, len);
+
+      SHA256_SetAccel(0);
+      auto portable = sha256Hex(cur, step);
+      SHA256_SetAccel(1);
+      auto accel = sha256Hex(cur, step);
+
+      same = same && portable == accel;
+    }
+  }
+
+  return same;
+}
+
+// hashRandomShards - hash of the random numbers of all shards
+uint64_t hashRandomShards(uint64_t seed, int shardNums, int threadNums) {
+  std::vector<uint64_t> lstHash(shardNums, 0);
+
+  natasha::runRandomShards(seed, shardNums, threadNums,
+                           [&lstHash](int shard, int thread) {
+                             uint64_t hash = 0;
+                             for (int i = 0; i < 1000; ++i) {
+                               hash = hash * 1000003 +
+                                      natasha::randomScale(1000000);
+                             }
+
+                             lstHash[shard] = hash;
+                           });
+
+  uint64_t hash = 0;
+  for (int i = 0; i < shardNums; ++i) {
+    hash = hash * 1000003 + lstHash[i];
+  }
+
+  return hash;
+}
+
+// JournalReplayResult - rounds of checkJournalReplay_tlod
+struct JournalReplayResult {
+  int roundNums;
+  int drawNums;
+  int64_t journalBytes;
+  bool isSame;
+  bool isTruncatedFail;
+};
+
+// checkJournalReplay_tlod - seeded gamectrls with journals, then replay the
+//                           journals with fortuna on a copy of the user
+::natashapb::CODE checkJournalReplay_tlod(natasha::TLOD& tlod, uint64_t seed,
+                                          int roundNums,
+                                          JournalReplayResult& result) {
+  result.roundNums = 0;
+  result.drawNums = 0;
+  result.journalBytes = 0;
+  result.isSame = true;
+  result.isTruncatedFail = false;
+
+  natasha::setThreadRandomSeed(seed);
+
+  ::natashapb::UserGameLogicInfo ugi;
+  natasha::UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = NULL;
+
+  auto code = tlod.userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::UserGameLogicInfo replayugi;
+  replayugi.CopyFrom(ugi);
+  natasha::UserInfo replayUser;
+  replayUser.pLogicUser = &replayugi;
+  replayUser.pCurConfig = NULL;
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl fg;
+  fg.mutable_freespin()->set_bet(1);
+  fg.mutable_freespin()->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+  fg.mutable_freespin()->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+  std::vector<std::string> lstJournal;
+  std::vector< ::natashapb::UserGameLogicInfo> lstUser(roundNums);
+  natasha::RandomJournal journal;
+
+  for (int i = 0; i < roundNums; ++i) {
+    auto pGameCtrl =
+        ugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(i + 1);
+
+    code = tlod.gameCtrlWithJournal(pGameCtrl, &user, journal);
+    if (code != ::natashapb::OK) {
+      natasha::clearThreadRandomSeed();
+      return code;
+    }
+
+    lstJournal.push_back(journal.getData());
+    lstUser[i].CopyFrom(ugi);
+
+    result.drawNums += journal.getNums();
+    result.journalBytes += journal.getData().size();
+  }
+
+  // 回放不用 seed，用的是 fortuna
+  natasha::clearThreadRandomSeed();
+
+  for (int i = 0; i < roundNums && result.isSame; ++i) {
+    auto pGameCtrl =
+        replayugi.nextgamemodtype() == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(i + 1);
+
+    // 少一个字节的记录不能通过
+    if (i == 0) {
+      ::natashapb::UserGameLogicInfo tmpugi;
+      tmpugi.CopyFrom(replayugi);
+      natasha::UserInfo tmpUser;
+      tmpUser.pLogicUser = &tmpugi;
+      tmpUser.pCurConfig = NULL;
+
+      natasha::RandomReplay truncated;
+      truncated.init(lstJournal[i].data(), lstJournal[i].size() - 1);
+
+      tlod.replayGameCtrl(pGameCtrl, &tmpUser, truncated);
+      result.isTruncatedFail =
+          truncated.getState() == natasha::RANDOMREPLAY_INVALID_DATA;
+    }
+
+    natasha::RandomReplay replay(lstJournal[i]);
+
+    code = tlod.replayGameCtrl(pGameCtrl, &replayUser, replay);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+
+    result.isSame = replay.isFinished() &&
+                    google::protobuf::util::MessageDifferencer::Equals(
+                        lstUser[i], replayugi);
+    result.roundNums++;
+  }
+
+  return ::natashapb::OK;
+}
+
+// refMuseumWildBomb - the wild bomb before the masks, board is y * 5 + x,
+//                     removed is updated, returns the positions in order
+std::vector<int> refMuseumWildBomb(const natasha::SymbolType* board,
+                                   bool* removed) {
+  std::vector<int> lst;
+
+  for (int y = 0; y < natasha::MUSEUM_HEIGHT; ++y) {
+    for (int x = 1; x < natasha::MUSEUM_WIDTH; ++x) {
+      if (board[y * natasha::MUSEUM_WIDTH + x] != natasha::MUSEUM_SYMBOL_W) {
+        continue;
+      }
+
+      for (int cy = y - 1; cy <= y + 1; ++cy) {
+        for (int cx = x - 1; cx <= x + 1; ++cx) {
+          if (cy < 0 || cy >= natasha::MUSEUM_HEIGHT || cx < 0 ||
+              cx >= natasha::MUSEUM_WIDTH) {
+            continue;
+          }
+
+          int i = cy * natasha::MUSEUM_WIDTH + cx;
+          if (removed[i]) {
+            continue;
+          }
+
+          if ((cx == x && cy == y) ||
+              (board[i] != natasha::MUSEUM_SYMBOL_W &&
+               board[i] != natasha::MUSEUM_SYMBOL_S)) {
+            lst.push_back(i);
+            removed[i] = true;
+          }
+        }
+      }
+    }
+  }
+
+  return lst;
+}
+
+// isSameMuseumWildBomb - museum_procWildBomb and refMuseumWildBomb give the
+//                        same positions on seeded random boards
+bool isSameMuseumWildBomb(const natasha::MuseumGameConfig& cfg, uint64_t seed,
+                          int boardNums) {
+  natasha::setThreadRandomSeed(seed);
+
+  const int size = natasha::MUSEUM_WIDTH * natasha::MUSEUM_HEIGHT;
+  bool same = true;
+
+  ::natashapb::UserGameModInfo ugmi;
+
+  for (int n = 0; n < boardNums && same; ++n) {
+    natasha::SymbolType board[size];
+    bool removed[size];
+
+    ::natashapb::SpinResult sr;
+    sr.set_specialtriggered(1);
+
+    auto psb = sr.mutable_symbolblock()->mutable_sb3x5();
+    auto pGRI = sr.add_lstgri();
+
+    for (int i = 0; i < size; ++i) {
+      // 一半是 W，这样经常有相邻的 wild
+      board[i] = natasha::randomScale(2) == 0
+                     ? natasha::MUSEUM_SYMBOL_W
+                     : natasha::randomScale(natasha::MeseumMaxSymbols);
+      removed[i] = natasha::randomScale(4) == 0;
+
+      int x = i % natasha::MUSEUM_WIDTH;
+      int y = i / natasha::MUSEUM_WIDTH;
+
+      natasha::setSymbolBlock3X5(psb, x, y, board[i]);
+
+      if (removed[i]) {
+        auto cp = pGRI->add_lstpos();
+        cp->set_x(x);
+        cp->set_y(y);
+      }
+    }
+
+    ugmi.mutable_cascadinginfo()->set_turnnums(n % 8);
+
+    auto lst = refMuseumWildBomb(board, removed);
+
+    natasha::MuseumSymbolMask masks;
+    masks.build(*psb);
+
+    int grinums = sr.lstgri_size();
+    auto win = natasha::museum_procWildBomb< ::natashapb::BASE_GAME>(
+        1, cfg, &ugmi, masks, &sr);
+
+    if (lst.empty()) {
+      same = win == 0 && sr.lstgri_size() == grinums;
+
+      continue;
+    }
+
+    if (sr.lstgri_size() != grinums + 1) {
+      same = false;
+
+      continue;
+    }
+
+    const auto& gri = sr.lstgri(grinums);
+    same = gri.lstpos_size() == (int)lst.size() &&
+           win == gri.mul() * (natasha::MoneyType)lst.size();
+
+    for (int i = 0; i < gri.lstpos_size() && same; ++i) {
+      same = gri.lstpos(i).y() * natasha::MUSEUM_WIDTH + gri.lstpos(i).x() ==
+             lst[i];
+    }
+  }
+
+  natasha::clearThreadRandomSeed();
+
+  return same;
+}
+
+// isSameMuseumModConfig - cfg is compiled from the fields of rtpcfg
+bool isSameMuseumModConfig(
+    const ::google::protobuf::RepeatedField< ::google::protobuf::int32>&
+        bonusprize,
+    const ::google::protobuf::RepeatedField< ::google::protobuf::int32>&
+        multipliers,
+    const ::google::protobuf::RepeatedPtrField< ::natashapb::WeightConfig>&
+        mysterywild,
+    const natasha::MuseumModRTPConfig& cfg) {
+  if (cfg.lstBonusPrize.size() != (size_t)bonusprize.size() ||
+      cfg.lstMultiplier.size() != (size_t)multipliers.size() ||
+      cfg.lstMysteryWild.size() != (size_t)mysterywild.size()) {
+    return false;
+  }
+
+  // 超出的 turnnums 都用最后一个
+  for (int i = 0; i < bonusprize.size() + 2; ++i) {
+    int j = std::min(i, bonusprize.size() - 1);
+    if (cfg.getBonusPrize(i) != bonusprize.Get(j)) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < multipliers.size(); ++i) {
+    if (cfg.lstMultiplier[i] != multipliers.Get(i)) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < mysterywild.size(); ++i) {
+    const auto& wc = mysterywild.Get(i);
+    const auto& wt = cfg.lstMysteryWild[i];
+
+    if (wt.totalWeight != wc.totalweight() ||
+        wt.lstWeight.size() != (size_t)wc.weights_size()) {
+      return false;
+    }
+
+    for (int j = 0; j < wc.weights_size(); ++j) {
+      if (wt.lstWeight[j] != wc.weights(j)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// MuseumRunResult - totals of seeded Museum gamectrls
+struct MuseumRunResult {
+  int64_t spinNums;
+  int64_t stepNums;
+  int64_t totalRealWin;
+  uint64_t hash;
+};
+
+// runMuseum - seeded gamectrls until spinNums paid spins are completed
+::natashapb::CODE runMuseum(natasha::Museum& museum, uint64_t seed,
+                            int spinNums, MuseumRunResult& result) {
+  natasha::setThreadRandomSeed(seed);
+
+  ::natashapb::UserGameLogicInfo ugi;
+  natasha::UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = (void*)museum.getGameConfig("rtp96");
+
+  ugi.set_configname("rtp96");
+
+  auto code = museum.userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    natasha::clearThreadRandomSeed();
+    return code;
+  }
+
+  ::natashapb::GameCtrl bg;
+  bg.mutable_spin()->set_bet(1);
+  bg.mutable_spin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  bg.mutable_spin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl fg;
+  fg.mutable_freespin()->set_bet(1);
+  fg.mutable_freespin()->set_lines(natasha::MUSEUM_DEFAULT_PAY_LINES);
+  fg.mutable_freespin()->set_times(natasha::MUSEUM_DEFAULT_TIMES);
+
+  result.spinNums = 0;
+  result.stepNums = 0;
+  result.totalRealWin = 0;
+  result.hash = 0;
+
+  std::hash<std::string> hashstr;
+  natasha::CtrlID ctrlid = 1;
+
+  while (result.spinNums < spinNums) {
+    auto gmt = ugi.nextgamemodtype() == ::natashapb::FREE_GAME
+                   ? ::natashapb::FREE_GAME
+                   : ::natashapb::BASE_GAME;
+    auto pGameCtrl = gmt == ::natashapb::FREE_GAME ? &fg : &bg;
+    pGameCtrl->set_ctrlid(ctrlid++);
+
+    code = museum.gameCtrl(pGameCtrl, &user);
+    if (code != ::natashapb::OK) {
+      natasha::clearThreadRandomSeed();
+      return code;
+    }
+
+    const auto& sr = museum.getUserGameModInfo(&user, gmt)->spinresult();
+
+    result.stepNums++;
+    result.totalRealWin += sr.realwin();
+    result.hash = result.hash * 1000003 + hashstr(sr.SerializeAsString());
+
+    if (ugi.iscompleted()) {
+      result.spinNums++;
+    }
+  }
+
+  natasha::clearThreadRandomSeed();
+
+  return ::natashapb::OK;
+}
+
+// tuneMuseum - a short tuning of rtp96 with threadNums threads
+::natashapb::CODE tuneMuseum(const char* cfgpath, int threadNums,
+                             ::natashapb::MuseumRTPConfig& rtpcfg,
+                             natasha::MuseumTuningResult& result) {
+  natasha::MuseumTuningConfig cfg;
+
+  cfg.configName = "rtp96";
+  cfg.target.rtp = 0.96;
+  cfg.target.rtpTolerance = 0.002;
+  cfg.target.volatility = 0;
+  cfg.target.volatilityTolerance = 1;
+  cfg.threadNums = threadNums;
+  cfg.shardNums = 64;
+  cfg.spinNums = 2000;
+  cfg.finalSpinNums = 10000;
+  cfg.maxRounds = 2;
+  cfg.seed = 20181212;
+
+  natasha::MuseumTuningParam param;
+  param.name = "bgbonusprize";
+  param.index = 0;
+  param.subindex = 0;
+  param.minValue = 1;
+  param.maxValue = 100;
+  param.step = 4;
+  cfg.lstParam.push_back(param);
+
+  return natasha::tuneMuseumRTPConfig(cfgpath, cfg, rtpcfg, result);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const char* cfgpath = argc > 1 ? argv[1] : "./csv";
+
+  {
+    int accel = SHA256_SetAccel(1);
+    bool kat = isSHA256KnownAnswer();
+    SHA256_SetAccel(0);
+    bool katPortable = isSHA256KnownAnswer();
+    SHA256_SetAccel(1);
+
+    printf("sha256 %s\n", accel ? "sha-ni" : "portable");
+    check(kat && katPortable, "SHA256 known answers");
+    check(isSHA256AccelSame(), "SHA256 sha-ni matches portable");
+  }
+
+  check(isExactAliasTable({1, 185, 15, 12, 75, 100}) &&
+            isExactAliasTable({0, 7, 0, 3}) && isExactAliasTable({5}),
+        "AliasTable is exact");
+
+  {
+    natasha::AliasTable table;
+    check(!natasha::buildAliasTable({}, table) &&
+              !natasha::buildAliasTable({0, 0}, table) &&
+              !natasha::buildAliasTable({3, -1}, table),
+          "AliasTable rejects invalid weights");
+  }
+
+  // reelsset.csv - reelsset_a.csv weight 1, reelsset_b.csv weight 3
+  {
+    natasha::NormalReelsSet3X5 set;
+    natasha::loadNormalReelsSet3X5(
+        cfgpath, natasha::pathAppend(cfgpath, "reelsset.csv").c_str(), set);
+
+    double p = -1;
+    if (set.getReelsNums() == 2) {
+      p = checkReelsSet(set, 10000);
+    }
+
+    check(p >= 0 && fabs(p - 0.75) < CHECK_SIGMA * sqrt(0.75 * 0.25 / 10000),
+          "NormalReelsSet3X5 is chosen by weight and kept by the cascade");
+
+    natasha::NormalReels3X5 bad;
+    natasha::loadNormalReels3X5(
+        natasha::pathAppend(cfgpath, "reels_badweight.csv").c_str(), bad);
+
+    check(bad.getReelsLength(0) == 0,
+          "loadNormalReels3X5 rejects a blank stop weight");
+  }
+
+  // the entropy thread feeds fortuna while random numbers are drawn
+  {
+    bool started = natasha::startEntropyThread(5);
+    bool startedAgain = natasha::startEntropyThread(5);
+
+    uint32_t sum = 0;
+    for (int i = 0; i < 10000; ++i) {
+      sum += natasha::randomScale(6);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    natasha::EntropyMetrics metrics;
+    natasha::getEntropyMetrics(metrics);
+
+    bool running = natasha::isEntropyThreadRunning();
+    natasha::stopEntropyThread();
+
+    check(started && !startedAgain && running &&
+              !natasha::isEntropyThreadRunning() && metrics.harvestNums >= 2 &&
+              metrics.harvestBytes >= metrics.harvestNums &&
+              metrics.totalReseedNums >= 1 && sum > 0,
+          "entropy thread");
+  }
+
+  // chi-square of the bounded and weighted draws, seeded
+  {
+    check(fabs(natasha::chiSquarePValue(3.841459, 1) - 0.05) < 1e-6 &&
+              fabs(natasha::chiSquarePValue(18.307038, 10) - 0.05) < 1e-6 &&
+              fabs(natasha::chiSquarePValue(124.342113, 100) - 0.05) < 1e-6,
+          "chi-square p-value");
+
+    ::natashapb::WeightConfig cfg;
+    for (int w : {1, 185, 15, 12, 75, 100}) {
+      cfg.add_weights(w);
+    }
+    cfg.set_totalweight(natasha::sumWeightConfig(cfg));
+
+    natasha::setThreadRandomSeed(20180808);
+
+    bool ok = true;
+    natasha::ChiSquareResult result;
+    for (uint32_t max : {6u, 37u, 1000u, 3000000000u}) {
+      ok = ok && natasha::testRandomScale(max, 1000000, 1000, result) &&
+           result.pValue > 1e-4;
+    }
+
+    ok = ok && natasha::testRandWeightConfig(cfg, 1000000, result) &&
+         result.pValue > 1e-4;
+    ok = ok && natasha::testRandAliasTable(cfg, 1000000, result) &&
+         result.pValue > 1e-4;
+
+    natasha::clearThreadRandomSeed();
+
+    check(ok, "chi-square of randomScale and weights");
+  }
+
+  // random shards only depend on seed and shardNums
+  {
+    auto hash1 = hashRandomShards(20180808, 64, 1);
+    auto hash8 = hashRandomShards(20180808, 64, 8);
+    auto hash64 = hashRandomShards(20180808, 64, 64);
+
+    natasha::setThreadRandomSeed(20180808);
+    uint32_t r0 = natasha::random();
+    natasha::setThreadRandomStream(20180808, 0);
+    uint32_t s0 = natasha::random();
+    natasha::setThreadRandomStream(20180808, 1);
+    uint32_t s1 = natasha::random();
+    natasha::clearThreadRandomSeed();
+
+    check(hash1 == hash8 && hash1 == hash64 &&
+              hash1 != hashRandomShards(20180809, 64, 8) && r0 == s0 &&
+              r0 != s1,
+          "random shards are identical for 1, 8 and 64 threads");
+  }
+
+  natasha::TLOD tlod;
+
+  auto code = tlod.init("./csv");
+  check(code == ::natashapb::OK, "TLOD init");
+  if (code != ::natashapb::OK) {
+    return 1;
+  }
+
+  // the same seed, the same result
+  MonteCarloResult mc0, mc1;
+  code = runMonteCarlo_tlod(tlod, 20180808, 20000, mc0);
+  check(code == ::natashapb::OK, "TLOD seeded run");
+  code = runMonteCarlo_tlod(tlod, 20180808, 20000, mc1);
+  check(code == ::natashapb::OK && mc0.stepNums == mc1.stepNums &&
+            mc0.totalWin == mc1.totalWin,
+        "TLOD seeded runs are identical");
+
+  // the lines cache does not change the result
+  {
+    natasha::TLOD tlodCache;
+    code = tlodCache.init("./csv");
+    tlodCache.enableLinesCache(4096);
+
+    MonteCarloResult mcCache;
+    if (code == ::natashapb::OK) {
+      code = runMonteCarlo_tlod(tlodCache, 20180808, 20000, mcCache);
+    }
+
+    auto pCache = tlodCache.getLinesCache();
+    check(code == ::natashapb::OK && mcCache.stepNums == mc0.stepNums &&
+              mcCache.totalWin == mc0.totalWin && pCache != NULL &&
+              pCache->getHitNums() > pCache->getMissNums(),
+          "TLOD lines cache gives the same result");
+  }
+
+  // a failed resolveGameCtrl leaves the user as it was
+  {
+    natasha::TLOD tlodFail;
+    int resultNums = 0;
+
+    code = tlodFail.init("./csv");
+    tlodFail.setFuncProcGameCtrlResult(
+        [&resultNums](::natashapb::UserGameLogicInfo* pLogicUser) {
+          ++resultNums;
+          return ::natashapb::OK;
+        });
+
+    ::natashapb::UserGameLogicInfo ugi;
+    natasha::UserInfo user;
+    user.pLogicUser = &ugi;
+    user.pCurConfig = NULL;
+
+    if (code == ::natashapb::OK) {
+      code = tlodFail.userComeIn(&user);
+    }
+
+    ::natashapb::GameCtrl gamectrl;
+    gamectrl.set_ctrlid(1);
+    auto spin = gamectrl.mutable_spin();
+    spin->set_bet(1);
+    spin->set_lines(natasha::TLOD_DEFAULT_PAY_LINES);
+    spin->set_times(natasha::TLOD_DEFAULT_TIMES);
+
+    natasha::ResolvedStepList lstStep;
+    if (code == ::natashapb::OK) {
+      code = tlodFail.resolveGameCtrl(&gamectrl, &user, lstStep, NULL);
+    }
+
+    check(code == ::natashapb::OK && resultNums == 1,
+          "TLOD resolveGameCtrl calls FuncProcGameCtrlResult once");
+
+    ::natashapb::UserGameLogicInfo lastugi;
+    lastugi.CopyFrom(ugi);
+    size_t lastStepNums = lstStep.size();
+
+    // lstBet 只有 1
+    gamectrl.set_ctrlid(1 + lastStepNums);
+    spin->set_bet(3);
+    code = tlodFail.resolveGameCtrl(&gamectrl, &user, lstStep, NULL);
+
+    check(code != ::natashapb::OK && resultNums == 1 &&
+              lstStep.size() == lastStepNums &&
+              google::protobuf::util::MessageDifferencer::Equals(lastugi,
+                                                                 ugi),
+          "TLOD failed resolveGameCtrl restores the user");
+  }
+
+#ifdef NATASHA_COUNTRTP
+  // the rtp counted in gamectrl is the sum of the spin results
+  {
+    natasha::RTP rtp = tlod.getRTP();
+    auto bg = rtp.getModule(::natashapb::BASE_GAME);
+    auto fg = rtp.getModule(::natashapb::FREE_GAME);
+
+    int64_t spinNums = mc0.spinNums + mc1.spinNums;
+    int64_t realWin = mc0.totalRealWin + mc1.totalRealWin;
+
+    check(rtp.rtp.totalbet() ==
+              spinNums * natasha::TLOD_DEFAULT_PAY_LINES &&
+              rtp.rtp.totalwin() == realWin,
+          "TLOD rtp totals match the spin results");
+    check(bg != NULL && fg != NULL && bg->spinnums() == spinNums &&
+              bg->totalwin() + fg->totalwin() == realWin,
+          "TLOD rtp modules match the spin results");
+  }
+#endif  // NATASHA_COUNTRTP
+
+  // the journal of a gamectrl replays the same round
+  {
+    JournalReplayResult jr;
+    code = checkJournalReplay_tlod(tlod, 20181111, 2000, jr);
+
+    check(code == ::natashapb::OK && jr.roundNums == 2000 && jr.isSame &&
+              jr.drawNums > 0,
+          "TLOD journal replays the same rounds");
+    check(jr.isTruncatedFail, "TLOD truncated journal fails");
+
+    printf("journal %.2f draws %.2f bytes per gamectrl\n",
+           (double)jr.drawNums / jr.roundNums,
+           (double)jr.journalBytes / jr.roundNums);
+  }
+
+  // markov chain with one seed, monte carlo with another one
+  natasha::setThreadRandomSeed(1);
+
+  natasha::CascadeTable table;
+  code = natasha::buildCascadeTable_tlod(tlod, CHECK_SPINNUMS, table);
+  check(code == ::natashapb::OK, "TLOD buildCascadeTable");
+
+  natasha::clearThreadRandomSeed();
+
+  natasha::CascadeRTPResult markov;
+  check(natasha::solveRTP_tlod(table, markov), "TLOD solveRTP");
+
+  MonteCarloResult mc;
+  code = runMonteCarlo_tlod(tlod, 2, CHECK_SPINNUMS, mc);
+  check(code == ::natashapb::OK, "TLOD monte carlo");
+
+  natasha::TLODExactResult exact;
+  code = natasha::countExactRTP_tlod(
+      "./csv", 1, natasha::TLOD_DEFAULT_PAY_LINES * 5000, exact);
+  check(code == ::natashapb::OK, "TLOD exact rtp");
+
+  printf("markov %.4f%% monte carlo %.4f%% (se %.4f%%) exact %.4f%%\n",
+         markov.totalRTP * 100, mc.getRTP() * 100, mc.getStdError() * 100,
+         exact.totalRTP * 100);
+
+  // 两次采样是独立的，误差是 sqrt(2) 倍
+  double se = mc.getStdError();
+  check(fabs(markov.totalRTP - mc.getRTP()) < CHECK_SIGMA * sqrt(2.0) * se,
+        "TLOD markov rtp matches monte carlo");
+  check(fabs(exact.totalRTP - mc.getRTP()) < CHECK_SIGMA * se,
+        "TLOD exact rtp matches monte carlo");
+  // the scenario outcome table is the exact base game
+  {
+    natasha::TLOD tlodOutcome;
+    code = tlodOutcome.init("./csv");
+    if (code == ::natashapb::OK) {
+      code = tlodOutcome.initScenarioOutcomes();
+    }
+
+    check(code == ::natashapb::OK, "TLOD initScenarioOutcomes");
+
+    natasha::UserInfo user;
+    user.pLogicUser = NULL;
+    user.pCurConfig = NULL;
+
+    auto pBG = static_cast<natasha::SlotsGameMod*>(
+        tlodOutcome.getGameMod(::natashapb::BASE_GAME));
+    int nums = pBG->getScenarioOutcomeNums(&user);
+
+    double bgWin = 0;
+    for (int i = 0; i < nums; ++i) {
+      bgWin += pBG->getScenarioOutcome(&user, i)->totalWin;
+    }
+
+    double bgRTP = nums > 0 ? bgWin / nums / natasha::TLOD_DEFAULT_PAY_LINES
+                            : 0;
+    check(nums == exact.bgScenarioNums && fabs(bgRTP - exact.bgRTP) < 1e-9,
+          "TLOD scenario outcomes match exact base game rtp");
+  }
+
+  // dist 是 bet 的倍数，超过 maxWin 的截断了，所以只能近似相等
+  check(fabs(exact.dist.getMean() / natasha::TLOD_DEFAULT_PAY_LINES -
+             exact.totalRTP) < 1e-3,
+        "TLOD exact distribution mean is rtp");
+
+  // the compiled Museum rtp config is the same as MuseumRTPConfig
+  {
+    natasha::Museum museumCfg;
+    museumCfg.initConfig();
+
+    auto pRTPCfg = museumCfg.getRTPConfig("rtp96");
+
+    natasha::MuseumGameConfig cfg;
+    code = pRTPCfg != NULL ? natasha::compileMuseumRTPConfig(*pRTPCfg, cfg)
+                           : ::natashapb::INVALID_REELS_CFG;
+
+    check(code == ::natashapb::OK && cfg.fgNums == pRTPCfg->fgnums() &&
+              isSameMuseumModConfig(pRTPCfg->bgbonusprize(),
+                                    pRTPCfg->bgmultipliers(),
+                                    pRTPCfg->bgmysterywild(), cfg.bg) &&
+              isSameMuseumModConfig(pRTPCfg->fgbonusprize(),
+                                    pRTPCfg->fgmultipliers(),
+                                    pRTPCfg->fgmysterywild(), cfg.fg),
+          "Museum compiled rtp config");
+
+    ::natashapb::MuseumRTPConfig zero;
+    if (pRTPCfg != NULL) {
+      zero.CopyFrom(*pRTPCfg);
+    }
+
+    auto pWeight = zero.mutable_bgmysterywild(0);
+    for (int i = 0; i < pWeight->weights_size(); ++i) {
+      pWeight->set_weights(i, 0);
+    }
+
+    pWeight->set_totalweight(0);
+
+    natasha::MuseumGameConfig cfgZero;
+    check(natasha::compileMuseumRTPConfig(zero, cfgZero) != ::natashapb::OK,
+          "Museum rejects zero mystery wild weights");
+
+    check(code == ::natashapb::OK &&
+              isSameMuseumWildBomb(cfg, 20181212, 100000),
+          "Museum wild bomb masks match the reference");
+  }
+
+  natasha::Museum museum;
+
+  code = museum.init(cfgpath);
+  check(code == ::natashapb::OK, "Museum init");
+  if (code != ::natashapb::OK) {
+    return 1;
+  }
+
+  // setRTPConfig swaps in a new config, recompileRTPConfig keeps it
+  {
+    auto pOld = museum.getGameConfig("rtp96");
+
+    ::natashapb::MuseumRTPConfig rtpcfg;
+    rtpcfg.CopyFrom(*museum.getRTPConfig("rtp96"));
+    rtpcfg.set_fgnums(rtpcfg.fgnums() + 3);
+
+    code = museum.setRTPConfig("rtp96", rtpcfg);
+    auto pNew = museum.getGameConfig("rtp96");
+
+    check(code == ::natashapb::OK && pNew != pOld &&
+              pNew->fgNums == rtpcfg.fgnums() &&
+              museum.isRetiredGameConfig(pOld) &&
+              museum.getRetiredGameConfigNums() == 1,
+          "Museum setRTPConfig retires the old config");
+
+    rtpcfg.mutable_bgmysterywild(0)->set_totalweight(0);
+    code = museum.setRTPConfig("rtp96", rtpcfg);
+
+    check(code != ::natashapb::OK && museum.getGameConfig("rtp96") == pNew &&
+              museum.getRetiredGameConfigNums() == 1,
+          "Museum invalid setRTPConfig keeps the config");
+
+    rtpcfg.CopyFrom(*museum.getRTPConfig("rtp96"));
+    rtpcfg.set_fgnums(rtpcfg.fgnums() - 3);
+
+    code = museum.recompileRTPConfig("rtp96", rtpcfg);
+    museum.releaseRetiredGameConfig();
+
+    check(code == ::natashapb::OK && museum.getGameConfig("rtp96") == pNew &&
+              pNew->fgNums == rtpcfg.fgnums() &&
+              museum.getRetiredGameConfigNums() == 0,
+          "Museum recompileRTPConfig keeps the config");
+  }
+
+  // the ways cache does not change the result
+  {
+    MuseumRunResult mr0, mr1;
+    code = runMuseum(museum, 20181212, 20000, mr0);
+
+    if (code == ::natashapb::OK) {
+      museum.enableWaysCache(4096);
+      code = runMuseum(museum, 20181212, 20000, mr1);
+    }
+
+    auto pCache = museum.getWaysCache();
+    check(code == ::natashapb::OK && mr0.stepNums == mr1.stepNums &&
+              mr0.totalRealWin == mr1.totalRealWin && mr0.hash == mr1.hash &&
+              pCache != NULL &&
+              pCache->getHitNums() + pCache->getMissNums() > 0,
+          "Museum ways cache gives the same result");
+
+    museum.enableWaysCache(0);
+  }
+
+  // the tuning result does not depend on threadNums
+  {
+    ::natashapb::MuseumRTPConfig rc1, rc8, rc64;
+    natasha::MuseumTuningResult tr1, tr8, tr64;
+
+    code = tuneMuseum(cfgpath, 1, rc1, tr1);
+    if (code == ::natashapb::OK) {
+      code = tuneMuseum(cfgpath, 8, rc8, tr8);
+    }
+
+    if (code == ::natashapb::OK) {
+      code = tuneMuseum(cfgpath, 64, rc64, tr64);
+    }
+
+    auto str1 = rc1.SerializeAsString();
+    check(code == ::natashapb::OK && tr1.rtp == tr8.rtp &&
+              tr1.rtp == tr64.rtp && tr1.volatility == tr8.volatility &&
+              tr1.volatility == tr64.volatility &&
+              tr1.candidateNums == tr8.candidateNums &&
+              tr1.candidateNums == tr64.candidateNums &&
+              str1 == rc8.SerializeAsString() &&
+              str1 == rc64.SerializeAsString(),
+          "Museum tuning is identical for 1, 8 and 64 threads");
+  }
+
+  return s_failNums > 0 ? 1 : 0;
+}
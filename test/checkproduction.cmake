@@ -0,0 +1,53 @@
+# checkproduction.cmake - the production libraries have no seeded random
+#   and no replay, they are only in the _sim libraries
+#   cmake -DNM=nm -DLIBS="a;b" -DSIMLIBS="c;d" -P checkproduction.cmake
+#   - SIMLIBS 里必须都有，这样改了函数名这个检查不会悄悄失效
+
+set(SIMSYMBOLS
+    setThreadRandomReplay
+    replayGameCtrl
+    setThreadRandomSeed
+    setThreadRandomStream
+    resetRandomSeed
+    fortuna_reset_with_seed)
+
+function(readsymbols libs out)
+  set(all "")
+  foreach(lib ${libs})
+    execute_process(COMMAND ${NM} -C ${lib}
+                    OUTPUT_VARIABLE symbols
+                    RESULT_VARIABLE result
+                    ERROR_QUIET)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "checkproduction: ${NM} ${lib} failed")
+    endif()
+
+    string(APPEND all "${symbols}")
+  endforeach()
+
+  set(${out} "${all}" PARENT_SCOPE)
+endfunction()
+
+readsymbols("${LIBS}" prodsymbols)
+readsymbols("${SIMLIBS}" simsymbols)
+
+set(failnums 0)
+foreach(sym ${SIMSYMBOLS})
+  string(FIND "${prodsymbols}" "${sym}" pos)
+  if(NOT pos EQUAL -1)
+    message(SEND_ERROR
+            "checkproduction: ${sym} is in the production libraries")
+    math(EXPR failnums "${failnums} + 1")
+  endif()
+
+  string(FIND "${simsymbols}" "${sym}" pos)
+  if(pos EQUAL -1)
+    message(SEND_ERROR
+            "checkproduction: ${sym} is not in the _sim libraries")
+    math(EXPR failnums "${failnums} + 1")
+  endif()
+endforeach()
+
+if(failnums EQUAL 0)
+  message(STATUS "checkproduction: ok")
+endif()
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include "../include/config.h"
+#include "../include/fortuna.h"
+#include "../include/rngquality.h"
+
+extern "C" {
+#include "../libfortuna/sha2.h"
+}
+
+// natasharng - throughput and chi-square report of the random number
+//              backends, for the certification lab
+//   natasharng [drawnums]
+//   drawnums 是每个 chi-square 测试的次数，默认 1000000
+//   输出是 tab 分隔的，可以直接贴到表格里
+
+namespace {
+
+// REPORT_SEED - seed of the simulation backend
+const uint64_t REPORT_SEED = 20180808;
+
+// REPORT_ALPHA - significance level of PASS / FAIL
+const double REPORT_ALPHA = 0.01;
+
+// THROUGHPUT_TIME - seconds for each throughput test
+const double THROUGHPUT_TIME = 0.5;
+
+// Backend - fortuna, or xoshiro256** of the simulations
+struct Backend {
+  const char* name;
+  bool isSimulation;
+};
+
+const Backend lstBackend[] = {{"fortuna", false},
+                              {"xoshiro256**", true}};
+
+void useBackend(const Backend& backend) {
+  if (backend.isSimulation) {
+    natasha::setThreadRandomSeed(REPORT_SEED);
+  } else {
+    natasha::clearThreadRandomSeed();
+  }
+}
+
+// measure - call func until THROUGHPUT_TIME, func returns the numbers drawn
+void measure(const Backend& backend, const char* api,
+             std::function<int()> func) {
+  useBackend(backend);
+
+  auto st = std::chrono::steady_clock::now();
+  int64_t draws = 0;
+  double t = 0;
+
+  do {
+    for (int i = 0; i < 1000; ++i) {
+      draws += func();
+    }
+
+    t = std::chrono::duration<double>(std::chrono::steady_clock::now() - st)
+            .count();
+  } while (t < THROUGHPUT_TIME);
+
+  printf("%s\t%s\t%.0f\t%.2f\n", backend.name, api, draws / t,
+         draws * sizeof(uint32_t) / t / 1024 / 1024);
+}
+
+void printChiSquare(const Backend& backend, const std::string& test, bool ok,
+                    const natasha::ChiSquareResult& result) {
+  if (!ok) {
+    printf("%s\t%s\tERROR\n", backend.name, test.c_str());
+
+    return;
+  }
+
+  printf("%s\t%s\t%lld\t%d\t%.4f\t%d\t%.6f\t%s\n", backend.name, test.c_str(),
+         (long long)result.drawNums, result.bins, result.chi2, result.dof,
+         result.pValue, result.pValue >= REPORT_ALPHA ? "PASS" : "FAIL");
+}
+
+// getWeightConfig - the weights of museum mystery wild
+::natashapb::WeightConfig getWeightConfig() {
+  ::natashapb::WeightConfig cfg;
+  for (int w : {1, 185, 15, 12, 75, 100}) {
+    cfg.add_weights(w);
+  }
+
+  cfg.set_totalweight(natasha::sumWeightConfig(cfg));
+
+  return cfg;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int64_t drawNums = argc > 1 ? atoll(argv[1]) : 1000000;
+  if (drawNums <= 0) {
+    printf("usage: natasharng [drawnums]\n");
+
+    return 1;
+  }
+
+  printf("# natasha rng report\n");
+  printf("# sha256\t%s\n", SHA256_SetAccel(1) ? "sha-ni" : "portable");
+  printf("# xoshiro256** seed\t%llu\n", (unsigned long long)REPORT_SEED);
+  printf("\n# throughput\n");
+  printf("backend\tapi\tdraws/s\tMB/s\n");
+
+  for (const auto& backend : lstBackend) {
+    uint32_t lst[15];
+    const uint32_t lstMax[5] = {60, 62, 64, 66, 68};
+
+    measure(backend, "random", [] {
+      natasha::random();
+      return 1;
+    });
+    measure(backend, "randomScale(6)", [] {
+      natasha::randomScale(6);
+      return 1;
+    });
+    measure(backend, "randomScale(3000000000)", [] {
+      natasha::randomScale(3000000000u);
+      return 1;
+    });
+    measure(backend, "randomArray(15)", [&lst] {
+      natasha::randomArray(lst, 15);
+      return 15;
+    });
+    measure(backend, "randomScaleArray(15, 1000)", [&lst] {
+      natasha::randomScaleArray(lst, 15, 1000);
+      return 15;
+    });
+    measure(backend, "randomScaleList(5)", [&lst, &lstMax] {
+      natasha::randomScaleList(lst, lstMax, 5);
+      return 5;
+    });
+  }
+
+  printf("\n# chi-square, alpha %.2f\n", REPORT_ALPHA);
+  printf("backend\ttest\tdraws\tbins\tchi2\tdof\tp\tresult\n");
+
+  auto cfg = getWeightConfig();
+
+  for (const auto& backend : lstBackend) {
+    for (uint32_t max : {2u, 3u, 5u, 6u, 10u, 37u, 100u, 1000u, 65536u,
+                         3000000000u}) {
+      natasha::ChiSquareResult result;
+
+      useBackend(backend);
+      bool ok = natasha::testRandomScale(max, drawNums, 1000, result);
+
+      printChiSquare(backend, "randomScale(" + std::to_string(max) + ")", ok,
+                     result);
+    }
+
+    natasha::ChiSquareResult result;
+
+    useBackend(backend);
+    bool ok = natasha::testRandWeightConfig(cfg, drawNums, result);
+    printChiSquare(backend, "randWeightConfig", ok, result);
+
+    useBackend(backend);
+    ok = natasha::testRandAliasTable(cfg, drawNums, result);
+    printChiSquare(backend, "randAliasTable", ok, result);
+  }
+
+  natasha::clearThreadRandomSeed();
+
+  return 0;
+}
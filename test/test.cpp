@@ -1,10 +1,16 @@
 #include <stdio.h>
 #include "../tlod/tlod.h"
+#include "../tlod/tlodexact.h"
 #include "../museum/museum.h"
+#include "../museum/museumtuning.h"
 
 int main() {
   natasha::countRTP_tlod();
   // natasha::countRTP_museum();
+  // natasha::countRTP_tlod_markov();
+  // natasha::countRTP_museum_markov();
+  // natasha::tuneRTP_museum();
+  // natasha::countRTP_tlod_exact();
 
   return 0;
 }
\ No newline at end of file
@@ -25,6 +25,11 @@ class TLODBaseGame : public SlotsGameMod {
  public:
   virtual ::natashapb::CODE init() { return ::natashapb::OK; }
 
+  // setLinesCache - set the result cache of lines
+  void setLinesCache(const ThreadBoardResultCache3X5& cache) {
+    m_linesCache = cache;
+  }
+
   // onUserComeIn -
   virtual ::natashapb::CODE onUserComeIn(const UserInfo* pUser,
                                          ::natashapb::UserGameModInfo* pUGMI) {
@@ -111,6 +116,20 @@ class TLODBaseGame : public SlotsGameMod {
     return ::natashapb::OK;
   }
 
+  // getScenarioNums - nums of all the scenarios
+  virtual int getScenarioNums(const UserInfo* pUser) {
+    return m_reels.getLength();
+  }
+
+  // setScenario - set the index-th scenario to random result
+  virtual ::natashapb::CODE setScenario(
+      ::natashapb::RandomResult* pRandomResult, int index,
+      const UserInfo* pUser) {
+    m_reels.randomWithIndex(pRandomResult, index);
+
+    return ::natashapb::OK;
+  }
+
   // countSpinResult - count spin result
   virtual ::natashapb::CODE countSpinResult(
       ::natashapb::SpinResult* pSpinResult,
@@ -123,7 +142,18 @@ class TLODBaseGame : public SlotsGameMod {
     assert(pUser != NULL);
     assert(pUGMI != NULL);
 
-    pSpinResult->Clear();
+    // 连消时上一步的结果还在 pSpinResult 里，没变的线直接复制
+    //   - 触发免费游戏那一步提前返回了，所以 END_FREEGAME 时不能用
+    ::natashapb::SpinResult prev;
+    bool hasPrev =
+        pUGMI->cascadinginfo().turnnums() > 0 &&
+        pUGMI->cascadinginfo().freestate() == ::natashapb::NO_FREEGAME &&
+        pSpinResult->has_symbolblock();
+    if (hasPrev) {
+      prev.Swap(pSpinResult);
+    } else {
+      pSpinResult->Clear();
+    }
 
     this->buildSpinResultSymbolBlock(pSpinResult, pUGMI, pGameCtrl,
                                      pRandomResult, pUser, NULL);
@@ -135,10 +165,12 @@ class TLODBaseGame : public SlotsGameMod {
 
     // printf("start TLODCountScatter");
     // First check free
+    TLODSymbolMask masks;
+    masks.build(pSpinResult->symbolblock().sb3x5());
+
     ::natashapb::GameResultInfo gri;
-    TLODCountScatter(gri, pSpinResult->symbolblock().sb3x5(), m_paytables,
-                     TLOD_SYMBOL_S,
-                     pGameCtrl->spin().bet() * TLOD_DEFAULT_PAY_LINES);
+    TLODCountScatterMask(gri, masks, m_paytables, TLOD_SYMBOL_S,
+                         pGameCtrl->spin().bet() * TLOD_DEFAULT_PAY_LINES);
     if (gri.typegameresult() == ::natashapb::SCATTER_LEFT) {
       auto pCurGRI = pSpinResult->add_lstgri();
       gri.set_win(0);
@@ -173,8 +205,20 @@ class TLODBaseGame : public SlotsGameMod {
     // printf("end TLODCountScatter");
 
     // check all line payout
-    TLODCountAllLine(*pSpinResult, pSpinResult->symbolblock().sb3x5(), m_lines,
-                     m_paytables, pGameCtrl->spin().bet());
+    //   - 开了缓存就用缓存，命中率很高
+    auto pCache = m_linesCache.get();
+    if (hasPrev && pCache == NULL) {
+      TLODPrevBoardResult prevResult;
+      prevResult.build(prev, prev.symbolblock().sb3x5(), masks);
+
+      TLODCountAllLineDirty(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
+                            masks, prevResult, m_lines, m_paytables,
+                            pGameCtrl->spin().bet());
+    } else {
+      TLODCountAllLineCache(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
+                            m_lines, m_paytables, pGameCtrl->spin().bet(),
+                            pCache);
+    }
 
     // printf("end TLODCountAllLine");
 
@@ -376,6 +420,7 @@ class TLODBaseGame : public SlotsGameMod {
   Paytables3X5& m_paytables;
   Lines3X5& m_lines;
   BetList& m_lstBet;
+  ThreadBoardResultCache3X5 m_linesCache;
 };
 
 }  // namespace natasha
@@ -25,6 +25,11 @@ class TLODFreeGame : public SlotsGameMod {
  public:
   virtual ::natashapb::CODE init() { return ::natashapb::OK; }
 
+  // setLinesCache - set the result cache of lines
+  void setLinesCache(const ThreadBoardResultCache3X5& cache) {
+    m_linesCache = cache;
+  }
+
   // start - start cur game module for user
   //    basegame does not need to handle this
   virtual ::natashapb::CODE start(::natashapb::UserGameModInfo* pUGMI,
@@ -159,6 +164,20 @@ class TLODFreeGame : public SlotsGameMod {
     return ::natashapb::OK;
   }
 
+  // getScenarioNums - nums of all the scenarios
+  virtual int getScenarioNums(const UserInfo* pUser) {
+    return m_reels.getLength();
+  }
+
+  // setScenario - set the index-th scenario to random result
+  virtual ::natashapb::CODE setScenario(
+      ::natashapb::RandomResult* pRandomResult, int index,
+      const UserInfo* pUser) {
+    m_reels.randomWithIndex(pRandomResult, index);
+
+    return ::natashapb::OK;
+  }
+
   // countSpinResult - count spin result
   virtual ::natashapb::CODE countSpinResult(
       ::natashapb::SpinResult* pSpinResult,
@@ -171,16 +190,26 @@ class TLODFreeGame : public SlotsGameMod {
     assert(pUser != NULL);
     assert(pUGMI != NULL);
 
-    pSpinResult->Clear();
+    // 连消时上一步的结果还在 pSpinResult 里，没变的线直接复制
+    ::natashapb::SpinResult prev;
+    bool hasPrev = pUGMI->cascadinginfo().turnnums() > 0 &&
+                   pSpinResult->has_symbolblock();
+    if (hasPrev) {
+      prev.Swap(pSpinResult);
+    } else {
+      pSpinResult->Clear();
+    }
 
     this->buildSpinResultSymbolBlock(pSpinResult, pUGMI, pGameCtrl,
                                      pRandomResult, pUser, NULL);
 
     // First check free
+    TLODSymbolMask masks;
+    masks.build(pSpinResult->symbolblock().sb3x5());
+
     ::natashapb::GameResultInfo gri;
-    TLODCountScatter(gri, pSpinResult->symbolblock().sb3x5(), m_paytables,
-                     TLOD_SYMBOL_S,
-                     pGameCtrl->freespin().bet() * TLOD_DEFAULT_PAY_LINES);
+    TLODCountScatterMask(gri, masks, m_paytables, TLOD_SYMBOL_S,
+                         pGameCtrl->freespin().bet() * TLOD_DEFAULT_PAY_LINES);
     if (gri.typegameresult() == ::natashapb::SCATTER_LEFT) {
       auto pCurGRI = pSpinResult->add_lstgri();
       gri.set_win(0);
@@ -193,8 +222,20 @@ class TLODFreeGame : public SlotsGameMod {
     }
 
     // check all line payout
-    TLODCountAllLine(*pSpinResult, pSpinResult->symbolblock().sb3x5(), m_lines,
-                     m_paytables, pGameCtrl->freespin().bet());
+    //   - 开了缓存就用缓存，命中率很高
+    auto pCache = m_linesCache.get();
+    if (hasPrev && pCache == NULL) {
+      TLODPrevBoardResult prevResult;
+      prevResult.build(prev, prev.symbolblock().sb3x5(), masks);
+
+      TLODCountAllLineDirty(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
+                            masks, prevResult, m_lines, m_paytables,
+                            pGameCtrl->freespin().bet());
+    } else {
+      TLODCountAllLineCache(*pSpinResult, pSpinResult->symbolblock().sb3x5(),
+                            m_lines, m_paytables, pGameCtrl->freespin().bet(),
+                            pCache);
+    }
 
     pSpinResult->set_awardmul(pUGMI->cascadinginfo().turnnums() + 3);
     pSpinResult->set_realwin(pSpinResult->win() * pSpinResult->awardmul());
@@ -361,6 +402,7 @@ class TLODFreeGame : public SlotsGameMod {
   Paytables3X5& m_paytables;
   Lines3X5& m_lines;
   BetList& m_lstBet;
+  ThreadBoardResultCache3X5 m_linesCache;
 };
 
 }  // namespace natasha
@@ -26,7 +26,9 @@ const int TLODMaxPayoutNums = 5;
 const char TLOD_SYMBOL_MAPPING[] = " wabcdefghijks";
 
 struct TLODGameCfg {
-  static bool isSameSymbol_OnLine(SymbolType s0, SymbolType s1) {
+  static const int MaxSymbols = TLODMaxSymbols;
+
+  static constexpr bool isSameSymbol_OnLine(SymbolType s0, SymbolType s1) {
     if (s0 == TLOD_SYMBOL_S || s1 == TLOD_SYMBOL_S) {
       return false;
     }
@@ -52,20 +54,46 @@ struct TLODGameCfg {
     return s == curws || s == TLOD_SYMBOL_W;
   }
 
-  static bool isScatter(SymbolType s) { return s == TLOD_SYMBOL_S; }
+  static constexpr bool isScatter(SymbolType s) { return s == TLOD_SYMBOL_S; }
 
-  static bool isWild(SymbolType s) { return s == TLOD_SYMBOL_S; }
+  static constexpr bool isWild(SymbolType s) { return s == TLOD_SYMBOL_W; }
 
   static int getMaxScstterNums(SymbolType s) { return TLOD_WIDTH; }
 };
 
+// TLODSymbolClass - TLODGameCfg with the symbol class tables
+//   - 算分的都用它，规则还是写在 TLODGameCfg 里
+typedef SymbolClass<TLODGameCfg> TLODSymbolClass;
+
 auto const TLODCountScatter =
     &countScatter_Left<MoneyType, SymbolType, TLOD_WIDTH, TLOD_HEIGHT,
-                       ::natashapb::SymbolBlock3X5, TLODGameCfg>;
+                       ::natashapb::SymbolBlock3X5, TLODSymbolClass>;
+
+// TLODSymbolMask - masks of the symbols on a board
+typedef SymbolMask<::natashapb::SymbolBlock3X5, TLOD_WIDTH, TLOD_HEIGHT,
+                   TLODMaxSymbols>
+    TLODSymbolMask;
+
+auto const TLODCountScatterMask =
+    &countScatter_Left_Mask<MoneyType, SymbolType, TLOD_WIDTH, TLOD_HEIGHT,
+                            TLODSymbolMask, TLODSymbolClass>;
 
 auto const TLODCountAllLine =
     &countAllLine_Left<MoneyType, SymbolType, TLOD_WIDTH, TLOD_HEIGHT,
-                       ::natashapb::SymbolBlock3X5, TLODGameCfg>;
+                       ::natashapb::SymbolBlock3X5, TLODSymbolClass>;
+
+auto const TLODCountAllLineCache =
+    &countAllLine_Left_Cache<MoneyType, SymbolType, TLOD_WIDTH, TLOD_HEIGHT,
+                             ::natashapb::SymbolBlock3X5, TLODSymbolClass>;
+
+// TLODPrevBoardResult - the last cascade step, for TLODCountAllLineDirty
+typedef PrevBoardResult<::natashapb::SymbolBlock3X5, TLODSymbolMask>
+    TLODPrevBoardResult;
+
+auto const TLODCountAllLineDirty =
+    &countAllLine_Left_Dirty<MoneyType, SymbolType, TLOD_WIDTH, TLOD_HEIGHT,
+                             ::natashapb::SymbolBlock3X5, TLODSymbolClass,
+                             TLODSymbolMask>;
 
 struct TLODUserConfig {
   StaticCascadingReels3X5* pReels;
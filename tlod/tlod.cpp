@@ -42,9 +42,76 @@ namespace natasha {
   addGameMod(::natashapb::FREE_GAME,
              new TLODFreeGame(*this, m_reels, m_paytables, m_lines, m_lstBet));
 
+  auto code = buildInitScenarios(::natashapb::BASE_GAME, NULL);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
   return GameLogic::init(cfgpath);
 }
 
+// initScenarioOutcomes - the outcome of every BG & FG scenario, in bet
+//                      - init 不会调用，要用 getScenarioOutcome 或
+//                        randomScenarioOutcome 时在 init 之后调用一次
+//                      - BG 里触发 FG 会改 rtp 统计，结束后还原
+::natashapb::CODE TLOD::initScenarioOutcomes() {
+#ifdef NATASHA_COUNTRTP
+  RTP rtp = m_rtp;
+#endif  // NATASHA_COUNTRTP
+
+  auto code = buildAllScenarioOutcomes();
+
+#ifdef NATASHA_COUNTRTP
+  m_rtp = rtp;
+#endif  // NATASHA_COUNTRTP
+
+  return code;
+}
+
+// buildAllScenarioOutcomes - build BG & FG scenario outcomes
+::natashapb::CODE TLOD::buildAllScenarioOutcomes() {
+  ::natashapb::GameCtrl gamectrlBG;
+  gamectrlBG.set_ctrlid(1);
+
+  auto spin = gamectrlBG.mutable_spin();
+  spin->set_bet(1);
+  spin->set_lines(TLOD_DEFAULT_PAY_LINES);
+  spin->set_times(TLOD_DEFAULT_TIMES);
+
+  auto code = buildScenarioOutcomes(::natashapb::BASE_GAME, NULL, &gamectrlBG);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::GameCtrl gamectrlFG;
+  gamectrlFG.set_ctrlid(1);
+
+  auto freespin = gamectrlFG.mutable_freespin();
+  freespin->set_bet(1);
+  freespin->set_lines(TLOD_DEFAULT_PAY_LINES);
+  freespin->set_times(TLOD_DEFAULT_TIMES);
+
+  return buildScenarioOutcomes(::natashapb::FREE_GAME, NULL, &gamectrlFG);
+}
+
+// enableLinesCache - cache the lines result of maxNums boards, 0 is disabled
+void TLOD::enableLinesCache(int maxNums) {
+  auto pBG = (TLODBaseGame*)getGameMod(::natashapb::BASE_GAME);
+  assert(pBG != NULL);
+
+  auto pFG = (TLODFreeGame*)getGameMod(::natashapb::FREE_GAME);
+  assert(pFG != NULL);
+
+  // 换一个 id，其他线程里旧的 cache 不会再用到
+  releaseThreadBoardResultCache<BoardResultCache3X5>(m_linesCache.id);
+
+  m_linesCache.id = newBoardResultCacheID();
+  m_linesCache.maxNums = maxNums;
+
+  pBG->setLinesCache(m_linesCache);
+  pFG->setLinesCache(m_linesCache);
+}
+
 // getMainGameMod - get current main game module
 GameMod* TLOD::getMainGameMod(UserInfo* pUser, bool isComeInGame) {
   auto pBG = getGameMod(::natashapb::BASE_GAME);
@@ -152,4 +219,94 @@ void countRTP_tlod() {
   printf("end!\n");
 }
 
+// buildCascadeTable_tlod - sample cascade steps
+//   BG 里出 scatter 以后立即进 FG，FG 结束后同一个盘面再算一次，
+//   所以 key 里还要区分 END_FREEGAME
+::natashapb::CODE buildCascadeTable_tlod(TLOD& tlod, int64_t spinNums,
+                                         CascadeTable& table) {
+  ::natashapb::UserGameLogicInfo ugi;
+  UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = NULL;
+
+  auto code = tlod.userComeIn(&user);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  ::natashapb::GameCtrl gamectrlBG;
+  auto spin = gamectrlBG.mutable_spin();
+  spin->set_bet(1);
+  spin->set_lines(TLOD_DEFAULT_PAY_LINES);
+  spin->set_times(TLOD_DEFAULT_TIMES);
+
+  ::natashapb::GameCtrl gamectrlFG;
+  auto freespin = gamectrlFG.mutable_freespin();
+  freespin->set_bet(1);
+  freespin->set_lines(TLOD_DEFAULT_PAY_LINES);
+  freespin->set_times(TLOD_DEFAULT_TIMES);
+
+  return sampleCascadeTable(
+      tlod, &user, &gamectrlBG, &gamectrlFG, spinNums,
+      [](::natashapb::GAMEMODTYPE module,
+         const ::natashapb::UserGameModInfo* pUGMI) {
+        auto turnnums = pUGMI->cascadinginfo().turnnums();
+        if (module == ::natashapb::BASE_GAME) {
+          return turnnums * 2 + (pUGMI->cascadinginfo().freestate() ==
+                                         ::natashapb::END_FREEGAME
+                                     ? 1
+                                     : 0);
+        }
+
+        return turnnums;
+      },
+      table);
+}
+
+// solveRTP_tlod - solve rtp with markov chain
+bool solveRTP_tlod(const CascadeTable& table, CascadeRTPResult& result) {
+  CascadeModel model;
+  model.isFGImmediately = true;
+
+  return solveCascadeRTP(table, model, getCascadeMeanRealWin, result);
+}
+
+// countRTP_tlod_markov - count rtp with markov chain
+void countRTP_tlod_markov() {
+  TLOD tlod;
+
+  printf("%ld\n", time(NULL));
+
+  auto c = tlod.init("./csv");
+  if (c != natashapb::OK) {
+    printf("init fail(%d)!\n", c);
+
+    return;
+  }
+
+  CascadeTable table;
+  c = buildCascadeTable_tlod(tlod, 1000000, table);
+  if (c != natashapb::OK) {
+    printf("buildCascadeTable_tlod fail(%d)!\n", c);
+
+    return;
+  }
+
+  printf("sampled rtp is %.4f%%\n",
+         table.getTotalRealWin() / table.getSpinNums() * 100);
+
+  CascadeRTPResult result;
+  if (!solveRTP_tlod(table, result)) {
+    printf("solveRTP_tlod fail!\n");
+
+    return;
+  }
+
+  outputCascadeRTPResult("tlod", result);
+
+  printf("%ld\n", time(NULL));
+
+  printf("end!\n");
+}
+
 }  // namespace natasha
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <vector>
+#include "../include/cascadetable.h"
 #include "../include/game3x5.h"
 #include "../include/gamelogic.h"
 #include "basegame.h"
@@ -14,17 +15,54 @@ namespace natasha {
 // countRTP_tlod - count rtp
 void countRTP_tlod();
 
+// countRTP_tlod_markov - count rtp with markov chain
+void countRTP_tlod_markov();
+
+class TLOD;
+
+// buildCascadeTable_tlod - sample cascade steps
+::natashapb::CODE buildCascadeTable_tlod(TLOD& tlod, int64_t spinNums,
+                                         CascadeTable& table);
+
+// solveRTP_tlod - solve rtp with markov chain
+bool solveRTP_tlod(const CascadeTable& table, CascadeRTPResult& result);
+
 // TLOD
 class TLOD : public GameLogic {
  public:
   TLOD() {}
-  virtual ~TLOD() {}
+  virtual ~TLOD() {
+    releaseThreadBoardResultCache<BoardResultCache3X5>(m_linesCache.id);
+  }
 
  public:
   virtual ::natashapb::CODE init(const char* cfgpath);
 
+  // initScenarioOutcomes - the outcome of every BG & FG scenario, in bet
+  //                      - init 不调用，只有要查表的才调用
+  ::natashapb::CODE initScenarioOutcomes();
+
   // getMainGameMod - get current main game module
   virtual GameMod* getMainGameMod(UserInfo* pUser, bool isComeInGame);
+
+ public:
+  // enableLinesCache - cache the lines result of maxNums boards, 0 is disabled
+  //                  - 默认关闭，init 以后调用，BG 和 FG 共用一个
+  //                  - 每个线程一个 cache，不能和 gameCtrl 同时调用
+  //                  - 盘面只来自 scenario 和 cascade，一共 1400 多个，
+  //                    4096 时实测命中率 99%
+  void enableLinesCache(int maxNums);
+
+  // getLinesCache - the lines cache of current thread, NULL if disabled
+  const BoardResultCache3X5* getLinesCache() const {
+    return m_linesCache.get();
+  }
+
+  const StaticCascadingReels3X5& getReels() const { return m_reels; }
+
+  const Paytables3X5& getPaytables() const { return m_paytables; }
+
+  const Lines3X5& getLines() const { return m_lines; }
 #ifdef NATASHA_COUNTRTP
  public:
   virtual void onInitRTP() {
@@ -36,11 +74,15 @@ class TLOD : public GameLogic {
 #ifdef NATASHA_RUNINCPP
   void initConfig();
 #endif  // NATASHA_RUNINCPP
+ protected:
+  ::natashapb::CODE buildAllScenarioOutcomes();
+
  protected:
   StaticCascadingReels3X5 m_reels;
   Paytables3X5 m_paytables;
   Lines3X5 m_lines;
   BetList m_lstBet;
+  ThreadBoardResultCache3X5 m_linesCache;
 };  // namespace natasha
 
 }  // namespace natasha
@@ -0,0 +1,403 @@
+#include "tlodexact.h"
+#include <map>
+#include <numeric>
+#include <thread>
+
+namespace natasha {
+
+// TLOD_EXACT_MINPROB - the probabilities less than it will be dropped
+const double TLOD_EXACT_MINPROB = 1e-18;
+// TLOD_EXACT_MAXITERATIONS - max iterations of the free game distribution
+const int TLOD_EXACT_MAXITERATIONS = 256;
+
+// resolveTLODScenarios - resolve [begin, end) scenarios in one thread
+static void resolveTLODScenarios(TLOD* pTLOD, ::natashapb::GAMEMODTYPE gmt,
+                                 int begin, int end, ScenarioOutcomeList* pLst,
+                                 ::natashapb::CODE* pCode) {
+  auto pMod = static_cast<SlotsGameMod*>(pTLOD->getGameMod(gmt));
+  assert(pMod != NULL);
+
+  ::natashapb::UserGameLogicInfo ugi;
+  UserInfo user;
+  user.pLogicUser = &ugi;
+  user.pCurConfig = NULL;
+
+  ::natashapb::GameCtrl gamectrl;
+  gamectrl.set_ctrlid(1);
+
+  if (gmt == ::natashapb::BASE_GAME) {
+    auto spin = gamectrl.mutable_spin();
+    spin->set_bet(1);
+    spin->set_lines(TLOD_DEFAULT_PAY_LINES);
+    spin->set_times(TLOD_DEFAULT_TIMES);
+  } else {
+    auto freespin = gamectrl.mutable_freespin();
+    freespin->set_bet(1);
+    freespin->set_lines(TLOD_DEFAULT_PAY_LINES);
+    freespin->set_times(TLOD_DEFAULT_TIMES);
+  }
+
+  *pCode = ::natashapb::OK;
+
+  for (int i = begin; i < end; ++i) {
+    *pCode = pMod->resolveScenario(&user, &gamectrl, i, (*pLst)[i], NULL);
+    if (*pCode != ::natashapb::OK) {
+      return;
+    }
+  }
+}
+
+// initTLODList - threadNums TLOD, one for each thread
+//   startGameMod 会改 GameLogic 里的 rtp 统计，所以不能共用一个 TLOD
+//   TLOD::init 不会枚举 scenario，下面的多线程枚举是唯一的一次
+static ::natashapb::CODE initTLODList(const char* cfgpath, int threadNums,
+                                      std::vector<TLOD*>& lstTLOD) {
+  assert(threadNums > 0);
+
+  for (int i = 0; i < threadNums; ++i) {
+    auto pTLOD = new TLOD();
+    lstTLOD.push_back(pTLOD);
+
+    auto code = pTLOD->init(cfgpath);
+    if (code != ::natashapb::OK) {
+      return code;
+    }
+  }
+
+  return ::natashapb::OK;
+}
+
+// releaseTLODList - delete all TLOD
+static void releaseTLODList(std::vector<TLOD*>& lstTLOD) {
+  for (auto it = lstTLOD.begin(); it != lstTLOD.end(); ++it) {
+    delete *it;
+  }
+
+  lstTLOD.clear();
+}
+
+// enumScenarioOutcomes - resolve every scenario of gmt, one thread for each
+//                        TLOD
+static ::natashapb::CODE enumScenarioOutcomes(std::vector<TLOD*>& lstTLOD,
+                                              ::natashapb::GAMEMODTYPE gmt,
+                                              ScenarioOutcomeList& lst) {
+  int threadNums = lstTLOD.size();
+  assert(threadNums > 0);
+
+  int nums = lstTLOD[0]->getReels().getLength();
+
+  lst.clear();
+  lst.resize(nums);
+
+  std::vector< ::natashapb::CODE> lstCode(threadNums, ::natashapb::OK);
+  std::vector<std::thread> lstThread;
+
+  for (int i = 0; i < threadNums; ++i) {
+    int begin = (int)((int64_t)nums * i / threadNums);
+    int end = (int)((int64_t)nums * (i + 1) / threadNums);
+
+    lstThread.push_back(std::thread(resolveTLODScenarios, lstTLOD[i], gmt,
+                                    begin, end, &lst, &lstCode[i]));
+  }
+
+  ::natashapb::CODE code = ::natashapb::OK;
+
+  for (int i = 0; i < threadNums; ++i) {
+    lstThread[i].join();
+
+    if (code == ::natashapb::OK) {
+      code = lstCode[i];
+    }
+  }
+
+  return code;
+}
+
+// enumScenarioOutcomes_tlod - resolve every scenario of gmt in threadNums
+//                             threads, every thread has its own TLOD
+::natashapb::CODE enumScenarioOutcomes_tlod(const char* cfgpath,
+                                            ::natashapb::GAMEMODTYPE gmt,
+                                            int threadNums,
+                                            ScenarioOutcomeList& lst) {
+  std::vector<TLOD*> lstTLOD;
+
+  auto code = initTLODList(cfgpath, threadNums, lstTLOD);
+  if (code == ::natashapb::OK) {
+    code = enumScenarioOutcomes(lstTLOD, gmt, lst);
+  }
+
+  releaseTLODList(lstTLOD);
+
+  return code;
+}
+
+// buildFreeSpinDist - win of one free spin and all the free spins it
+//                     retriggers
+//   每次 free spin 都是独立的，所以
+//     G = A + sum(p_j * shift(G ^ fgnums_j, win_j))
+//   A 是不会再触发的 free spin，迭代到收敛
+static ::natashapb::CODE buildFreeSpinDist(const ScenarioOutcomeList& lstFG,
+                                           int maxWin, int unit,
+                                           PayoutDist& dist) {
+  double p = 1.0 / lstFG.size();
+
+  PayoutDist distA(maxWin, unit);
+  // fgnums -> list of win
+  std::map<int, std::vector<MoneyType> > mapRetrigger;
+  double retriggerNums = 0;
+
+  for (auto it = lstFG.begin(); it != lstFG.end(); ++it) {
+    if (it->fgNums > 0) {
+      mapRetrigger[it->fgNums].push_back(it->totalWin);
+      retriggerNums += p * it->fgNums;
+    } else {
+      distA.add(it->totalWin, p);
+    }
+  }
+
+  // 每次 free spin 平均触发超过 1 次就永远不会结束
+  if (retriggerNums >= 1) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  dist = distA;
+
+  PayoutDist distNext(maxWin, unit);
+  PayoutDist distPower(maxWin, unit);
+
+  for (int i = 0; i < TLOD_EXACT_MAXITERATIONS; ++i) {
+    if (mapRetrigger.empty()) {
+      break;
+    }
+
+    distNext = distA;
+
+    for (auto it = mapRetrigger.begin(); it != mapRetrigger.end(); ++it) {
+      distPower.power(dist, it->first);
+      distPower.prune(TLOD_EXACT_MINPROB);
+
+      for (auto itWin = it->second.begin(); itWin != it->second.end();
+           ++itWin) {
+        distNext.addShift(distPower, *itWin, p);
+      }
+    }
+
+    distNext.prune(TLOD_EXACT_MINPROB);
+
+    double delta = distNext.getTotalProb() - dist.getTotalProb();
+    dist = distNext;
+
+    if (delta < TLOD_EXACT_MINPROB) {
+      break;
+    }
+  }
+
+  return ::natashapb::OK;
+}
+
+// countExactRTP_tlod - exact rtp and payout distribution of TLOD
+//   maxWin - in bet, wins more than maxWin are counted as maxWin
+::natashapb::CODE countExactRTP_tlod(const char* cfgpath, int threadNums,
+                                     int maxWin, TLODExactResult& result) {
+  // BG 和 FG 用同一组 TLOD
+  std::vector<TLOD*> lstTLOD;
+  ScenarioOutcomeList lstBG;
+  ScenarioOutcomeList lstFG;
+
+  auto code = initTLODList(cfgpath, threadNums, lstTLOD);
+  if (code == ::natashapb::OK) {
+    code = enumScenarioOutcomes(lstTLOD, ::natashapb::BASE_GAME, lstBG);
+  }
+
+  if (code == ::natashapb::OK) {
+    code = enumScenarioOutcomes(lstTLOD, ::natashapb::FREE_GAME, lstFG);
+  }
+
+  releaseTLODList(lstTLOD);
+
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  if (lstBG.empty() || lstFG.empty()) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  const double totalbet = TLOD_DEFAULT_PAY_LINES * TLOD_DEFAULT_TIMES;
+
+  result.bgScenarioNums = lstBG.size();
+  result.fgScenarioNums = lstFG.size();
+
+  // mean of a free spin, and the free spins it retriggers
+  double fgWin = 0;
+  double retriggerNums = 0;
+  for (auto it = lstFG.begin(); it != lstFG.end(); ++it) {
+    fgWin += it->totalWin;
+    retriggerNums += it->fgNums;
+  }
+
+  fgWin /= lstFG.size();
+  retriggerNums /= lstFG.size();
+
+  if (retriggerNums >= 1) {
+    return ::natashapb::INVALID_REELS_CFG;
+  }
+
+  // a free spin brings 1 / (1 - retriggerNums) free spins
+  double spinsPerFreeSpin = 1 / (1 - retriggerNums);
+
+  double bgWin = 0;
+  double fgNums = 0;
+  double triggerNums = 0;
+  for (auto it = lstBG.begin(); it != lstBG.end(); ++it) {
+    bgWin += it->totalWin;
+
+    for (auto itStep = it->lstStep.begin(); itStep != it->lstStep.end();
+         ++itStep) {
+      if (itStep->fgNums > 0) {
+        fgNums += itStep->fgNums;
+        triggerNums++;
+      }
+    }
+  }
+
+  bgWin /= lstBG.size();
+  fgNums /= lstBG.size();
+  triggerNums /= lstBG.size();
+
+  result.bgRTP = bgWin / totalbet;
+  result.fgRTP = fgNums * spinsPerFreeSpin * fgWin / totalbet;
+  result.totalRTP = result.bgRTP + result.fgRTP;
+  result.fgTriggerNums = triggerNums;
+  result.fgSpinNums =
+      triggerNums > 0 ? fgNums * spinsPerFreeSpin / triggerNums : 0;
+
+  // payout distribution, all the wins are multiples of unit
+  MoneyType gcdWin = 0;
+  for (auto it = lstBG.begin(); it != lstBG.end(); ++it) {
+    gcdWin = std::gcd(gcdWin, it->totalWin);
+  }
+
+  for (auto it = lstFG.begin(); it != lstFG.end(); ++it) {
+    gcdWin = std::gcd(gcdWin, it->totalWin);
+  }
+
+  int unit = gcdWin > 0 ? (int)gcdWin : 1;
+
+  PayoutDist distFreeSpin(maxWin, unit);
+  code = buildFreeSpinDist(lstFG, maxWin, unit, distFreeSpin);
+  if (code != ::natashapb::OK) {
+    return code;
+  }
+
+  // fgnums -> win of the free game
+  std::map<int, PayoutDist> mapFreeGame;
+
+  result.dist.init(maxWin, unit);
+
+  double p = 1.0 / lstBG.size();
+  PayoutDist distCur(maxWin, unit);
+  PayoutDist distTmp(maxWin, unit);
+
+  for (auto it = lstBG.begin(); it != lstBG.end(); ++it) {
+    if (it->fgNums <= 0) {
+      result.dist.add(it->totalWin, p);
+
+      continue;
+    }
+
+    distCur.init(maxWin, unit);
+    distCur.add(it->totalWin, 1);
+
+    for (auto itStep = it->lstStep.begin(); itStep != it->lstStep.end();
+         ++itStep) {
+      if (itStep->fgNums <= 0) {
+        continue;
+      }
+
+      auto itFG = mapFreeGame.find(itStep->fgNums);
+      if (itFG == mapFreeGame.end()) {
+        PayoutDist& distFG = mapFreeGame[itStep->fgNums];
+        distFG.power(distFreeSpin, itStep->fgNums);
+        distFG.prune(TLOD_EXACT_MINPROB);
+
+        itFG = mapFreeGame.find(itStep->fgNums);
+      }
+
+      distTmp.convolve(distCur, itFG->second);
+      distCur = distTmp;
+    }
+
+    result.dist.addShift(distCur, 0, p);
+  }
+
+  result.hitRate = 1 - result.dist.getProb(0);
+
+  return ::natashapb::OK;
+}
+
+// outputExactRTP_tlod - print result
+void outputExactRTP_tlod(const TLODExactResult& result) {
+  const double totalbet = TLOD_DEFAULT_PAY_LINES * TLOD_DEFAULT_TIMES;
+
+  printf("tlod exact rtp is %.4f%%\n", result.totalRTP * 100);
+  printf("bg scenarios is %d\n", result.bgScenarioNums);
+  printf("fg scenarios is %d\n", result.fgScenarioNums);
+  printf("bg rtp is %.4f%%\n", result.bgRTP * 100);
+  printf("fg rtp is %.4f%%\n", result.fgRTP * 100);
+  printf("hit rate is %.4f%%\n", result.hitRate * 100);
+  printf("fg trigger is %.6f\n", result.fgTriggerNums);
+  printf("fg spins is %.6f\n", result.fgSpinNums);
+  printf("distribution rtp is %.4f%%\n",
+         result.dist.getMean() / totalbet * 100);
+
+  // in totalbet
+  const double lstEdge[] = {0, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+  const int edgeNums = sizeof(lstEdge) / sizeof(lstEdge[0]);
+
+  printf("win(totalbet),prob\n");
+  printf("0,%.8f\n", result.dist.getProb(0));
+
+  for (int i = 0; i < edgeNums; ++i) {
+    MoneyType minWin = i == 0 ? 1 : (MoneyType)(lstEdge[i] * totalbet);
+    MoneyType maxWin = i == edgeNums - 1
+                           ? result.dist.getMaxWin() + 1
+                           : (MoneyType)(lstEdge[i + 1] * totalbet);
+
+    if (i == edgeNums - 1) {
+      printf("%g+,%.8f\n", lstEdge[i],
+             result.dist.getRangeProb(minWin, maxWin));
+    } else {
+      printf("%g-%g,%.8f\n", lstEdge[i], lstEdge[i + 1],
+             result.dist.getRangeProb(minWin, maxWin));
+    }
+  }
+}
+
+// countRTP_tlod_exact - count exact rtp
+void countRTP_tlod_exact() {
+  printf("%ld\n", time(NULL));
+
+  int threadNums = std::thread::hardware_concurrency();
+  if (threadNums <= 0) {
+    threadNums = 1;
+  }
+
+  TLODExactResult result;
+  auto c = countExactRTP_tlod(
+      "./csv", threadNums, TLOD_DEFAULT_PAY_LINES * TLOD_DEFAULT_TIMES * 5000,
+      result);
+  if (c != natashapb::OK) {
+    printf("countExactRTP_tlod fail(%d)!\n", c);
+
+    return;
+  }
+
+  outputExactRTP_tlod(result);
+
+  printf("%ld\n", time(NULL));
+
+  printf("end!\n");
+}
+
+}  // namespace natasha
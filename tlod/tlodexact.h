@@ -0,0 +1,49 @@
+#ifndef __NATASHA_TLODEXACT_H__
+#define __NATASHA_TLODEXACT_H__
+
+#include <assert.h>
+#include <vector>
+#include "../include/payoutdist.h"
+#include "tlod.h"
+
+namespace natasha {
+
+// TLODExactResult - exact rtp of TLOD
+//   每个 scenario 是均匀随机的，所以枚举全部 scenario 就是精确值
+struct TLODExactResult {
+  int bgScenarioNums;
+  int fgScenarioNums;
+  double bgRTP;
+  double fgRTP;
+  double totalRTP;
+  // hitRate - probability of a paid spin (with free game) win > 0
+  double hitRate;
+  // fgTriggerNums - mean nums of free game triggered in a paid spin
+  double fgTriggerNums;
+  // fgSpinNums - mean nums of free spins in a free game, with retrigger
+  double fgSpinNums;
+  // dist - win of a paid spin (with free game), in bet
+  PayoutDist dist;
+};
+
+// enumScenarioOutcomes_tlod - resolve every scenario of gmt in threadNums
+//                             threads, every thread has its own TLOD
+::natashapb::CODE enumScenarioOutcomes_tlod(const char* cfgpath,
+                                            ::natashapb::GAMEMODTYPE gmt,
+                                            int threadNums,
+                                            ScenarioOutcomeList& lst);
+
+// countExactRTP_tlod - exact rtp and payout distribution of TLOD
+//   maxWin - in bet, wins more than maxWin are counted as maxWin
+::natashapb::CODE countExactRTP_tlod(const char* cfgpath, int threadNums,
+                                     int maxWin, TLODExactResult& result);
+
+// outputExactRTP_tlod - print result
+void outputExactRTP_tlod(const TLODExactResult& result);
+
+// countRTP_tlod_exact - count exact rtp
+void countRTP_tlod_exact();
+
+}  // namespace natasha
+
+#endif  // __NATASHA_TLODEXACT_H__